@@ -66,6 +66,7 @@
                                  INCLUDE FILES
  =============================================================================*/
 #include "emb6.h"
+#include "emb6_conf.h"
 #include "board_conf.h"
 #include "bsp.h"
 #include "etimer.h"
@@ -111,6 +112,10 @@
 #include "rpl.h"
 #endif
 
+#if EMB6_SIM
+#include "sim.h"
+#endif
+
 /*==============================================================================
                                      MACROS
  =============================================================================*/
@@ -122,6 +127,10 @@
 /*==============================================================================
                           LOCAL VARIABLE DECLARATIONS
  =============================================================================*/
+#if EMB6_SIM
+/* Network stack of a simulated node, swapped with the node context */
+static s_ns_t st_simNetstack;
+#endif /* EMB6_SIM */
 /*==============================================================================
                                 LOCAL CONSTANTS
  =============================================================================*/
@@ -245,6 +254,40 @@ static uint8_t loc_demoAppsInit(void)
     return 1;
 }
 
+#if EMB6_SIM
+/*==============================================================================
+ sim_nodeInit()
+==============================================================================*/
+uint8_t sim_nodeInit(uint8_t c_root)
+{
+    st_simNetstack.c_configured = 0;
+    loc_initialConfig();
+
+    if (!loc_demoAppsConf(&st_simNetstack)) {
+        return 0;
+    }
+
+    if (!emb6_init(&st_simNetstack)) {
+        return 0;
+    }
+
+    #if UIP_CONF_IPV6_RPL
+    if (c_root && !emb6_dagRootInit()) {
+        return 0;
+    }
+    #endif
+
+    return loc_demoAppsInit();
+}
+
+/*==============================================================================
+ sim_nodeRun()
+==============================================================================*/
+uint8_t sim_nodeRun(uint32_t * pl_deadline)
+{
+    return emb6_processEvents(pl_deadline);
+}
+#else
 /*==============================================================================
  main()
 ==============================================================================*/
@@ -293,5 +336,6 @@ int main(void)
     printf("Program failed.");
     while(1);
 }
+#endif /* EMB6_SIM */
 /** @} */
 /** @} */
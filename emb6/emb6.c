@@ -62,6 +62,7 @@
 #include "tcpip.h"
 #include "bsp.h"
 #include "queuebuf.h"
+#include "mmem.h"
 #include "linkaddr.h"
 #include "ctimer.h"
 #include "random.h"
@@ -83,10 +84,6 @@
 
 uint8_t loc_emb6NetstackInit(s_ns_t * ps_netstack);
 
-#ifdef EMB6_INIT_DROOT
-static int8_t   loc_emb6DagRootInit(void);
-#endif
-
 /*==============================================================================
                            TYPEDEFS
  =============================================================================*/
@@ -136,8 +133,8 @@ s_mac_phy_conf_t mac_phy_config = {
 };
 
 
-#if EMB6_INIT_ROOT==TRUE
-static int8_t loc_emb6DagRootInit(void)
+#if UIP_CONF_IPV6_RPL
+int8_t emb6_dagRootInit(void)
 {
     uip_ipaddr_t un_ipaddr;
     struct uip_ds6_addr *root_if;
@@ -163,7 +160,7 @@ static int8_t loc_emb6DagRootInit(void)
     }
     return 1;
 }
-#endif /* DEMO_USE_DAG_ROOT  */
+#endif /* UIP_CONF_IPV6_RPL */
 
 /*==============================================================================
                                  LOCAL FUNCTIONS
@@ -174,6 +171,7 @@ uint8_t loc_emb6NetstackInit(s_ns_t * ps_ns)
     uint8_t     c_err = 0;
     /* Initialize stack protocols */
     queuebuf_init();
+    mmem_init();
     ctimer_init();
     if ((ps_ns->hc != NULL) && (ps_ns->llsec != NULL) && (ps_ns->hmac != NULL) &&
         (ps_ns->lmac != NULL) && (ps_ns->frame != NULL) && (ps_ns->inif != NULL)) {
@@ -190,7 +188,7 @@ uint8_t loc_emb6NetstackInit(s_ns_t * ps_ns)
     }
 
 #if EMB6_INIT_ROOT==TRUE
-    if (!c_err || !loc_emb6DagRootInit()) {
+    if (!c_err || !emb6_dagRootInit()) {
         c_err = 1;
     }
 #endif /* DEMO_USE_DAG_ROOT */
@@ -227,8 +225,37 @@ s_ns_t * emb6_get(void)
 }
 
 
+uint8_t emb6_processEvents(clock_time_t * pl_deadline)
+{
+    do {
+        etimer_request_poll();
+        /* Handle every pending event before reporting the next deadline */
+    } while (evproc_nextEvent() != E_QUEUE_EMPTY);
+
+    if (!etimer_pending())
+        return 0;
+
+    /* A timer expires one tick after its expiration time */
+    *pl_deadline = etimer_next_expiration_time() + 1;
+    return 1;
+}
+
 void emb6_process(uint16_t us_delay)
 {
+#if EMB6_TICKLESS
+    clock_time_t l_deadline = 0;
+    uint8_t c_wakeSrc;
+
+    (void)us_delay;
+    /* Attention: emb6 main process loop !! do not change !! */
+    while(1)
+    {
+        c_wakeSrc = HAL_WAKE_IRQ | HAL_WAKE_FD;
+        if (emb6_processEvents(&l_deadline))
+            c_wakeSrc |= HAL_WAKE_TIMER;
+        bsp_waitUntil(l_deadline, c_wakeSrc);
+    }
+#else
     /* Attention: emb6 main process loop !! do not change !! */
     while(1)
     {
@@ -236,6 +263,7 @@ void emb6_process(uint16_t us_delay)
         etimer_request_poll();
         bsp_delay_us(us_delay);
     }
+#endif /* EMB6_TICKLESS */
 }
 
 /** @} */
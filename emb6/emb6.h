@@ -435,6 +435,8 @@ extern const s_nsIf_t           rf212_driver;
 extern const s_nsIf_t           rf212b_driver;
 extern const s_nsIf_t           rf230_driver;
 extern const s_nsIf_t           native_driver;
+extern const s_nsIf_t           native_shm_driver;
+extern const s_nsIf_t           native_sim_driver;
 
 
 
@@ -458,7 +460,10 @@ uint8_t emb6_init(s_ns_t * ps_netstack);
 /*!
 \brief   emb6 process function
 
-    This function handles all events and timers of the emb6 stack in a loop
+    This function handles all events and timers of the emb6 stack in a loop.
+    If EMB6_TICKLESS is set, the loop handles all pending events and then
+    sleeps in bsp_waitUntil() until the next timer deadline or a wake up
+    source. The delay is not used in this mode.
 
 \param 	 delay sets a delay in µs at the end of the function
 
@@ -468,6 +473,33 @@ uint8_t emb6_init(s_ns_t * ps_netstack);
 /*============================================================================*/
 void emb6_process(uint16_t delay);
 
+/*============================================================================*/
+/*!
+\brief   Handle all pending events and expired timers of the emb6 stack
+
+    This is a single iteration of the emb6_process() loop for environments
+    which run the stack by their own, e.g. the simulator of the native_sim
+    board. It returns as soon as the event queue is empty.
+
+\param   pl_deadline    set to the tick at which the next timer expires
+
+\return  1 if a timer is pending and pl_deadline was set, 0 otherwise
+*/
+/*============================================================================*/
+uint8_t emb6_processEvents(clock_time_t * pl_deadline);
+
+/*============================================================================*/
+/*!
+\brief   Start a RPL DODAG with this node as root
+
+    Called during emb6_init() if EMB6_INIT_ROOT is set. Can be called
+    afterwards to select the root at run time.
+
+\return  returns 0 if failed, 1 if success
+*/
+/*============================================================================*/
+int8_t emb6_dagRootInit(void);
+
 /*============================================================================*/
 /*!
 \brief   Function which assign a given pointer to a current network stack ptr
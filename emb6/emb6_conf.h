@@ -69,6 +69,23 @@
 #define     EMB6_INIT_ROOT                     FALSE
 #endif
 
+/** Main loop mode. If TRUE emb6_process() handles all pending events and
+    then waits in bsp_waitUntil() for the next timer deadline or an interrupt
+    instead of polling with a fixed delay */
+#ifdef EMB6_CONF_TICKLESS
+#define     EMB6_TICKLESS                      EMB6_CONF_TICKLESS
+#else
+#define     EMB6_TICKLESS                      FALSE
+#endif /* EMB6_CONF_TICKLESS */
+
+/** Simulation build. If TRUE the stack is built as shared object which is
+    driven by the simulator of the native_sim board instead of main() */
+#ifdef EMB6_CONF_SIM
+#define     EMB6_SIM                           EMB6_CONF_SIM
+#else
+#define     EMB6_SIM                           FALSE
+#endif /* EMB6_CONF_SIM */
+
 /** Define a network prefix for dag root */
 #define NETWORK_PREFIX_DODAG                   0xaaaa, 0x0000, 0x0000, 0x0000
 
@@ -340,6 +357,67 @@
 #define UIP_CONF_IPV6_QUEUE_PKT             TRUE
 #endif
 
+/**
+ * Number of IPv6 packet buffers of uip-packetqueue. They hold received
+ * packets which were not processed yet.
+ */
+#ifdef UIP_CONF_PACKETQUEUE_NUM
+#define UIP_PACKETQUEUE_NUM                 (UIP_CONF_PACKETQUEUE_NUM)
+#else
+#define UIP_PACKETQUEUE_NUM                 1
+#endif
+
+/** Bytes of all packets waiting for address resolution */
+#ifdef UIP_CONF_PACKETQUEUE_BYTES
+#define UIP_PACKETQUEUE_BYTES               (UIP_CONF_PACKETQUEUE_BYTES)
+#else
+#define UIP_PACKETQUEUE_BYTES               (2 * UIP_CONF_BUFFER_SIZE)
+#endif
+
+/** Number of packets waiting for address resolution */
+#ifdef UIP_CONF_PACKETQUEUE_ENTRIES
+#define UIP_PACKETQUEUE_ENTRIES             (UIP_CONF_PACKETQUEUE_ENTRIES)
+#else
+#define UIP_PACKETQUEUE_ENTRIES             4
+#endif
+
+/** Number of packets waiting for the address resolution of one neighbor */
+#ifdef UIP_CONF_PACKETQUEUE_NBR_MAX
+#define UIP_PACKETQUEUE_NBR_MAX             (UIP_CONF_PACKETQUEUE_NBR_MAX)
+#else
+#define UIP_PACKETQUEUE_NBR_MAX             3
+#endif
+
+/** Bytes of CoAP responses kept to answer duplicate requests */
+#ifdef COAP_CONF_EXCHANGE_BYTES
+#define COAP_EXCHANGE_BYTES                 (COAP_CONF_EXCHANGE_BYTES)
+#else
+#define COAP_EXCHANGE_BYTES                 192
+#endif
+
+/** Bytes of confirmable CoAP messages waiting for their acknowledgement */
+#ifdef COAP_CONF_TRANSACTION_BYTES
+#define COAP_TRANSACTION_BYTES              (COAP_CONF_TRANSACTION_BYTES)
+#else
+#define COAP_TRANSACTION_BYTES              256
+#endif
+
+/** Managed memory of the CoAP exchange cache and transactions, only
+ *  reserved when the application uses CoAP */
+#if DEMO_USE_COAP
+#define COAP_MMEM_BYTES                     (COAP_EXCHANGE_BYTES + \
+                                             COAP_TRANSACTION_BYTES)
+#else
+#define COAP_MMEM_BYTES                     0
+#endif
+
+/** Size of the managed memory, it holds the packets of the ND queues and
+ *  the bytes of COAP_MMEM_BYTES */
+#ifndef MMEM_CONF_SIZE
+#define MMEM_CONF_SIZE                      (UIP_PACKETQUEUE_BYTES + \
+                                             COAP_MMEM_BYTES)
+#endif
+
 /** Default uip_aligned_buf and sicslowpan_aligned_buf sizes of 1280 overflows RAM */
 #ifndef UIP_CONF_BUFFER_SIZE
 #define UIP_CONF_BUFFER_SIZE                240
@@ -382,6 +460,44 @@
 #define SICSLOWPAN_REASS_MAXAGE             20
 #endif
 
+/**
+ * Number of datagrams the 6lowpan layer reassembles at the same time.
+ * Each context takes a buffer of UIP_BUFSIZE bytes.
+ */
+#ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
+#define SICSLOWPAN_REASS_CONTEXTS           (SICSLOWPAN_CONF_REASS_CONTEXTS)
+#else
+#define SICSLOWPAN_REASS_CONTEXTS           2
+#endif
+
+/**
+ * Relay the fragments of datagrams routed through this node as they
+ * arrive, instead of reassembling them first. Only the first fragment
+ * is uncompressed to take the routing decision.
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARD
+#define SICSLOWPAN_FRAG_FORWARD             (SICSLOWPAN_CONF_FRAG_FORWARD)
+#else
+#define SICSLOWPAN_FRAG_FORWARD             0
+#endif
+
+/** Number of datagrams whose fragments are relayed at the same time */
+#ifdef SICSLOWPAN_CONF_VRB_ENTRIES
+#define SICSLOWPAN_VRB_ENTRIES              (SICSLOWPAN_CONF_VRB_ENTRIES)
+#else
+#define SICSLOWPAN_VRB_ENTRIES              4
+#endif
+
+/**
+ * Number of flows whose compressed IPHC addresses are kept, so packets
+ * of a known flow skip the address compression. 0 disables it.
+ */
+#ifdef SICSLOWPAN_CONF_HC06_FLOWS
+#define SICSLOWPAN_HC06_FLOWS               (SICSLOWPAN_CONF_HC06_FLOWS)
+#else
+#define SICSLOWPAN_HC06_FLOWS               2
+#endif
+
 /**
  * Determines if uIP should use a fixed IP address or not.
  *
@@ -48,11 +48,24 @@
 #define COAP_SERVER_PORT               COAP_DEFAULT_PORT
 #endif
 
-/* The number of concurrent messages that can be stored for retransmission in the transaction layer. */
+/* The number of concurrent messages in the transaction layer, their bytes are set by COAP_TRANSACTION_BYTES */
 #ifndef COAP_MAX_OPEN_TRANSACTIONS
-#define COAP_MAX_OPEN_TRANSACTIONS     4
+#define COAP_MAX_OPEN_TRANSACTIONS     (COAP_TRANSACTION_BYTES / 64)
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/* Number of messages that can be built at the same time, e.g. a response and a notification */
+#ifndef COAP_TRANSACTION_BUFFERS
+#define COAP_TRANSACTION_BUFFERS       2
+#endif /* COAP_TRANSACTION_BUFFERS */
+
+/* Buckets of the transaction lookup by MID, must be a power of two */
+#ifndef COAP_TRANSACTION_BUCKETS
+#define COAP_TRANSACTION_BUCKETS       8
+#endif /* COAP_TRANSACTION_BUCKETS */
+#if COAP_TRANSACTION_BUCKETS == 0 || (COAP_TRANSACTION_BUCKETS & (COAP_TRANSACTION_BUCKETS - 1)) != 0
+#error "COAP_TRANSACTION_BUCKETS must be a power of two"
+#endif
+
 /* Maximum number of failed request attempts before action */
 #ifndef COAP_MAX_ATTEMPTS
 #define COAP_MAX_ATTEMPTS              4
@@ -63,11 +76,34 @@
 #define COAP_MAX_HEADER_SIZE           (4 + COAP_TOKEN_LEN + 3 + 1 + COAP_ETAG_LEN + 4 + 4 + 30)  /* 65 */
 #endif /* COAP_MAX_HEADER_SIZE */
 
-/* Number of observer slots (each takes abot xxx bytes) */
+/* Number of responses kept to answer duplicate requests, their bytes are set by COAP_EXCHANGE_BYTES */
+#ifndef COAP_MAX_EXCHANGES
+#define COAP_MAX_EXCHANGES             COAP_MAX_OPEN_TRANSACTIONS
+#endif /* COAP_MAX_EXCHANGES */
+
+/* Seconds a response is kept for duplicate requests (EXCHANGE_LIFETIME of RFC 7252) */
+#ifndef COAP_EXCHANGE_LIFETIME
+#define COAP_EXCHANGE_LIFETIME         247
+#endif /* COAP_EXCHANGE_LIFETIME */
+
+/* Number of observer slots, notifications only take a transaction while they wait for an ACK */
 #ifndef COAP_MAX_OBSERVERS
-#define COAP_MAX_OBSERVERS    COAP_MAX_OPEN_TRANSACTIONS - 1
+#define COAP_MAX_OBSERVERS             3
 #endif /* COAP_MAX_OBSERVERS */
 
+/* Buckets of each observer lookup (by resource, token and MID), must be a power of two */
+#ifndef COAP_OBSERVER_BUCKETS
+#define COAP_OBSERVER_BUCKETS          4
+#endif /* COAP_OBSERVER_BUCKETS */
+#if COAP_OBSERVER_BUCKETS == 0 || (COAP_OBSERVER_BUCKETS & (COAP_OBSERVER_BUCKETS - 1)) != 0
+#error "COAP_OBSERVER_BUCKETS must be a power of two"
+#endif
+
+/* Number of notification representations that confirmable notifications can share */
+#ifndef COAP_SHARED_MESSAGES
+#define COAP_SHARED_MESSAGES           2
+#endif /* COAP_SHARED_MESSAGES */
+
 /* Interval in notifies in which NON notifies are changed to CON notifies to check client. */
 #define COAP_OBSERVE_REFRESH_INTERVAL  20
 
@@ -0,0 +1,77 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *      CoAP exchange cache for the suppression of duplicate requests.
+ */
+
+#ifndef COAP_EXCHANGE_H_
+#define COAP_EXCHANGE_H_
+
+#include "er-coap.h"
+#include "mmem.h"
+#include "timer.h"
+
+/* response to a request, kept until its exchange lifetime is over */
+typedef struct coap_exchange {
+  struct coap_exchange *next;   /* for LIST */
+
+  uip_ipaddr_t addr;
+  uint16_t port;
+  uint16_t mid;
+
+  struct timer lifetime;
+  struct mmem response;
+} coap_exchange_t;
+
+typedef struct coap_exchange_stats {
+  uint32_t hits;        /* duplicates answered from the cache */
+  uint32_t misses;      /* requests passed to the resource handlers */
+  uint32_t evicted;     /* responses dropped before their lifetime */
+  uint32_t expired;     /* responses dropped after their lifetime */
+} coap_exchange_stats_t;
+
+void coap_exchange_init(void);
+int coap_exchange_replay(uip_ipaddr_t *addr, uint16_t port, uint16_t mid);
+void coap_exchange_store(uip_ipaddr_t *addr, uint16_t port, uint16_t mid,
+                         const uint8_t *response, uint16_t response_len);
+const coap_exchange_stats_t *coap_exchange_get_stats(void);
+
+#endif /* COAP_EXCHANGE_H_ */
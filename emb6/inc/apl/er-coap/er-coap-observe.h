@@ -53,6 +53,9 @@ typedef struct coap_observable {
 
 typedef struct coap_observer {
   struct coap_observer *next;   /* for LIST */
+  struct coap_observer *url_next;       /* next observer with the same url hash */
+  struct coap_observer *token_next;     /* next observer with the same token hash */
+  struct coap_observer *mid_next;       /* next observer with the same MID hash */
 
   const char *url;
   uip_ipaddr_t addr;
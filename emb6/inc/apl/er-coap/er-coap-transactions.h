@@ -41,6 +41,7 @@
 
 #include "er-coap.h"
 #include "bsp.h"
+#include "mmem.h"
 
 /*
  * Modulo mask (thus +1) for a random number to get the tick number for the random
@@ -49,9 +50,24 @@
 #define COAP_RESPONSE_TIMEOUT_TICKS         (bsp_get(E_BSP_GET_TRES) * COAP_RESPONSE_TIMEOUT)
 #define COAP_RESPONSE_TIMEOUT_BACKOFF_MASK  (long)((bsp_get(E_BSP_GET_TRES) * COAP_RESPONSE_TIMEOUT * ((float)COAP_RESPONSE_RANDOM_FACTOR - 1.0)) + 0.5) + 1
 
+/*
+ * Buffer a message is built in before it is sent for the first time.
+ * Confirmable messages then move to the managed memory until acknowledged.
+ */
+typedef struct coap_transaction_buffer {
+  uint8_t packet[COAP_MAX_PACKET_SIZE + 1];     /* +1 for the terminating '\0' which will not be sent
+                                                 * Use snprintf(buf, len+1, "", ...) to completely fill payload */
+} coap_transaction_buffer_t;
+
+/* end of a message shared by several transactions, e.g. notifications */
+typedef struct coap_shared_message {
+  uint16_t refs;
+  struct mmem data;
+} coap_shared_message_t;
+
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction {
-  struct coap_transaction *next;        /* for LIST */
+  struct coap_transaction *next;        /* next transaction with the same MID hash */
 
   uint16_t mid;
   struct etimer retrans_timer;
@@ -64,8 +80,9 @@ typedef struct coap_transaction {
   void *callback_data;
 
   uint16_t packet_len;
-  uint8_t packet[COAP_MAX_PACKET_SIZE + 1];     /* +1 for the terminating '\0' which will not be sent
-                                                 * Use snprintf(buf, len+1, "", ...) to completely fill payload */
+  uint8_t *packet;              /* build buffer, NULL once the message is stored */
+  struct mmem stored;           /* message kept for retransmissions */
+  coap_shared_message_t *shared; /* sent after the packet if set */
 } coap_transaction_t;
 
 /* void coap_register_as_transaction_handler(); */    /* not needed */
@@ -76,6 +93,11 @@ void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
-void coap_check_transactions();
+void coap_check_transaction(struct etimer *retrans_timer);
+
+coap_shared_message_t *coap_new_shared_message(const uint8_t *data,
+                                               uint16_t len);
+void coap_share_message(coap_transaction_t *t, coap_shared_message_t *s);
+void coap_release_shared_message(coap_shared_message_t *s);
 
 #endif /* COAP_TRANSACTIONS_H_ */
@@ -67,6 +67,14 @@
 #define REST_MAX_CHUNK_SIZE     64
 #endif
 
+/*
+ * Number of URI-path trie nodes used for resource dispatch, one per distinct
+ * path segment. Resources that do not fit are found by a linear scan.
+ */
+#ifndef REST_TRIE_NODES
+#define REST_TRIE_NODES         16
+#endif
+
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif /* MIN */
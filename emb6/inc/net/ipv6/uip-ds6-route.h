@@ -89,6 +89,16 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB UIP_CONF_MAX_ROUTES
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* Index the routing table with a path compressed binary trie. Lookups
+   walk at most one trie node per address bit and leave the route list
+   untouched; the least recently used route is found by a time stamp
+   when the table is full. Needs two trie nodes per route. */
+#ifdef UIP_CONF_DS6_ROUTE_TRIE
+#define UIP_DS6_ROUTE_TRIE UIP_CONF_DS6_ROUTE_TRIE
+#else
+#define UIP_DS6_ROUTE_TRIE 0
+#endif /* UIP_CONF_DS6_ROUTE_TRIE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -111,6 +121,7 @@ struct uip_ds6_route_neighbor_routes {
 /** \brief An entry in the routing table */
 typedef struct uip_ds6_route {
   struct uip_ds6_route *next;
+  struct uip_ds6_route *prev;
   /* Each route entry belongs to a specific neighbor. That neighbor
      holds a list of all routing entries that go through it. The
      routes field point to the uip_ds6_route_neighbor_routes that
@@ -120,6 +131,10 @@ typedef struct uip_ds6_route {
   uip_ipaddr_t ipaddr;
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
+#endif
+#if UIP_DS6_ROUTE_TRIE
+  /* Lookup counter value of the last use, for eviction */
+  uint32_t last_used;
 #endif
   uint8_t length;
 } uip_ds6_route_t;
@@ -6,24 +6,63 @@
 #define UIP_PACKETQUEUE_H
 
 #include "ctimer.h"
+#include "timer.h"
+#include "mmem.h"
 
 struct uip_packetqueue_handle;
 
 struct uip_packetqueue_packet {
-  struct uip_ds6_queued_packet *next;
+  struct uip_packetqueue_packet *next;
   uint8_t queue_buf[UIP_BUFSIZE - UIP_LLH_LEN];
   uint16_t queue_buf_len;
   struct ctimer lifetimer;
   struct uip_packetqueue_handle *handle;
 };
 
+/**
+ * A packet in the queue of a handle. The packet data is kept in mmem,
+ * so a packet only takes as many bytes of UIP_PACKETQUEUE_BYTES as it
+ * is long.
+ */
+struct uip_packetqueue_entry {
+  /** All queued packets, the least recently queued first */
+  struct uip_packetqueue_entry *next;
+  struct uip_packetqueue_entry *prev;
+  /** Next packet of the same handle */
+  struct uip_packetqueue_entry *qnext;
+  struct uip_packetqueue_handle *handle;
+  struct mmem mem;
+  struct timer lifetimer;
+};
+
 struct uip_packetqueue_handle {
   struct uip_packetqueue_packet *packet;
+  /** Queued packets, oldest first */
+  struct uip_packetqueue_entry *queue;
+  uint8_t queue_len;
 };
 
-void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
+/** Counters of the packet queues */
+struct uip_packetqueue_stats {
+  /** Packets which were queued */
+  uint32_t queued;
+  /** Packets which were taken from a queue to be sent */
+  uint32_t dequeued;
+  /** Packets which were dropped to make room for a newer one */
+  uint32_t evicted;
+  /** Packets which were dropped as their lifetime expired */
+  uint32_t timedout;
+  /** Packets which could not be queued */
+  uint32_t dropped;
+};
 
+void uip_packetqueue_new(struct uip_packetqueue_handle *handle);
 
+/**
+ * Take a packet buffer from the pool of UIP_PACKETQUEUE_NUM buffers.
+ * The buffer is freed again after \p lifetime, or is kept until
+ * uip_packetqueue_free() if \p lifetime is 0.
+ */
 struct uip_packetqueue_packet *
 uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifetime);
 
@@ -35,5 +74,31 @@ uint8_t *uip_packetqueue_buf(struct uip_packetqueue_handle *h);
 uint16_t uip_packetqueue_buflen(struct uip_packetqueue_handle *h);
 void uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len);
 
+/** Number of packet buffers left in the pool */
+int uip_packetqueue_numfree(void);
+
+/**
+ * Append the packet in uip_buf to the queue of a handle.
+ *
+ * A handle keeps at most UIP_PACKETQUEUE_NBR_MAX packets, its oldest
+ * packet is dropped for a newer one. If all queues together exceed
+ * UIP_PACKETQUEUE_ENTRIES packets or UIP_PACKETQUEUE_BYTES bytes, the
+ * least recently queued packets of any handle are dropped.
+ * \param lifetime Time after which the packet is dropped
+ * \return 1 if the packet was queued, 0 otherwise
+ */
+int uip_packetqueue_enqueue(struct uip_packetqueue_handle *h,
+                            clock_time_t lifetime);
+
+/**
+ * Move the oldest packet of a handle to uip_buf.
+ * \return The length of the packet, which is also set in uip_len, or 0
+ * if the queue of the handle is empty
+ */
+uint16_t uip_packetqueue_dequeue(struct uip_packetqueue_handle *h);
+
+/** Get the counters of the packet queues */
+void uip_packetqueue_get_stats(struct uip_packetqueue_stats *stats);
+
 
 #endif /* UIP_PACKETQUEUE_H */
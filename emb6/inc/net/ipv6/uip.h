@@ -2207,6 +2207,36 @@ uint16_t uip_udpchksum(void);
  */
 uint16_t uip_icmp6chksum(void);
 
+/**
+ * Remove a part of a packet from its checksum.
+ *
+ * Together with uip_chksum_add() this updates the checksum of a
+ * packet when a few of its bytes are rewritten, without summing the
+ * rest of the packet again (RFC1624, eqn. 3). The bytes are removed
+ * before and added again after they were changed. A part must start
+ * at an even offset of the checksummed data.
+ *
+ * \param chksum The checksum field of the packet, in network byte order.
+ * \param data A pointer to the bytes which are removed.
+ * \param len The number of bytes.
+ *
+ * \return The updated checksum field in network byte order.
+ */
+uint16_t uip_chksum_remove(uint16_t chksum, const uint8_t *data, uint16_t len);
+
+/**
+ * Add a part of a packet to its checksum.
+ *
+ * \sa uip_chksum_remove()
+ *
+ * \param chksum The checksum field of the packet, in network byte order.
+ * \param data A pointer to the bytes which are added.
+ * \param len The number of bytes.
+ *
+ * \return The updated checksum field in network byte order.
+ */
+uint16_t uip_chksum_add(uint16_t chksum, const uint8_t *data, uint16_t len);
+
 
 #endif /* UIP_H_ */
 
@@ -103,6 +103,19 @@ void uip_add32(uint8_t *op32, uint16_t op16);
  */
 uint16_t uip_chksum(uint16_t *data, uint16_t len);
 
+/**
+ * Add a buffer to a one's complement sum.
+ * Targets which set UIP_ARCH_CHKSUM provide this function and all
+ * checksums of uIP are computed with it. The buffer is summed as
+ * 16-bit words in network byte order, a trailing odd byte is padded
+ * with zero. Neither the buffer nor its length need to be aligned.
+ * \param sum The one's complement sum so far in host byte order.
+ * \param data A pointer to the buffer which is added to the sum.
+ * \param len The length of the buffer.
+ * \return The folded one's complement sum in host byte order.
+ */
+uint16_t uip_arch_chksum(uint16_t sum, const uint8_t *data, uint16_t len);
+
 /**
  * Calculate the IP header checksum of the packet header in uip_buf.
  *
@@ -315,6 +315,20 @@ struct sicslowpan_nh_compressor {
 
 int sicslowpan_get_last_rssi(void);
 
+/** Counters of the 6lowpan reassembly */
+struct sicslowpan_reass_stats {
+  /** Datagrams reassembled and passed to the IP layer */
+  uint32_t completed;
+  /** Datagrams discarded to make room for a new one */
+  uint32_t evicted;
+  /** Datagrams discarded after SICSLOWPAN_REASS_MAXAGE */
+  uint32_t timedout;
+  /** Datagrams relayed fragment by fragment, see SICSLOWPAN_FRAG_FORWARD */
+  uint32_t forwarded;
+};
+
+void sicslowpan_get_reass_stats(struct sicslowpan_reass_stats *stats);
+
 
 #endif /* SICSLOWPAN_H_ */
 /** @} */
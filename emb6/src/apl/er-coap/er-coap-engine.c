@@ -98,8 +98,6 @@ coap_receive(void)
 
     if(erbium_status_code == NO_ERROR) {
 
-      /*TODO duplicates suppression, if required by application */
-
       PRINTF("  Parsed: v %u, t %u, tkl %u, c %u, mid %u\n\r", message->version,
              message->type, message->token_len, message->code, message->mid);
       PRINTF("  URL: %d|%s\n\r", message->uri_path_len, message->uri_path);
@@ -108,8 +106,13 @@ coap_receive(void)
       /* handle requests */
       if(message->code >= COAP_GET && message->code <= COAP_DELETE) {
 
-        /* use transaction buffer for response to confirmable request */
-        if((transaction =
+        /* answer duplicates with the response sent before */
+        if(coap_exchange_replay(&UIP_IP_BUF->srcipaddr, UIP_UDP_BUF->srcport,
+                                message->mid)) {
+          transaction = NULL;
+
+          /* use transaction buffer for response to confirmable request */
+        } else if((transaction =
               coap_new_transaction(message->mid, &UIP_IP_BUF->srcipaddr,
                                    UIP_UDP_BUF->srcport))) {
           uint32_t block_num = 0;
@@ -269,6 +272,9 @@ coap_receive(void)
     /* if(parsed correctly) */
     if(erbium_status_code == NO_ERROR) {
       if(transaction) {
+        coap_exchange_store(&transaction->addr, transaction->port,
+                            message->mid, transaction->packet,
+                            transaction->packet_len);
         coap_send_transaction(transaction);
       }
     } else if(erbium_status_code == MANUAL_RESPONSE) {
@@ -329,6 +335,7 @@ coap_init_engine(void)
 {
   PRINTF("Starting %s receiver...\n\r", coap_rest_implementation.name);
   rest_activate_resource(&res_well_known_core, ".well-known/core");
+  coap_exchange_init();
 
   coap_init_connection(SERVER_LISTEN_PORT,
                       (udp_socket_input_callback_t)coap_receive);
@@ -339,7 +346,7 @@ coap_engine_callback(c_event_t c_event, p_data_t p_data)
 {
     if(c_event == EVENT_TYPE_TIMER_EXP) {
       /* retransmissions are handled here */
-      coap_check_transactions();
+      coap_check_transaction((struct etimer *)p_data);
     }
 }
 /*---------------------------------------------------------------------------*/
@@ -0,0 +1,189 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *      CoAP exchange cache for the suppression of duplicate requests.
+ *
+ *      The serialized response to every request is kept together with the
+ *      source address, port and MID of the request. A retransmitted request
+ *      gets the same response again without invoking the resource handler.
+ *      The responses live in the managed memory within COAP_EXCHANGE_BYTES,
+ *      the oldest exchange is dropped first when the cache is full.
+ */
+
+#include <string.h>
+
+#include "emb6.h"
+#include "bsp.h"
+#include "clist.h"
+#include "memb.h"
+
+#include "er-coap-exchange.h"
+
+#define DEBUG DEBUG_NONE
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/*---------------------------------------------------------------------------*/
+MEMB(exchanges_memb, coap_exchange_t, COAP_MAX_EXCHANGES);
+LIST(exchanges_list);
+
+static uint16_t exchanges_bytes;
+static coap_exchange_stats_t exchanges_stats;
+
+/*---------------------------------------------------------------------------*/
+static void
+exchange_free(coap_exchange_t *e)
+{
+  exchanges_bytes -= e->response.size;
+  mmem_free(&e->response);
+  list_remove(exchanges_list, e);
+  memb_free(&exchanges_memb, e);
+}
+/*---------------------------------------------------------------------------*/
+static void
+exchange_purge(void)
+{
+  coap_exchange_t *e;
+  coap_exchange_t *next;
+
+  for(e = list_head(exchanges_list); e; e = next) {
+    next = e->next;
+    if(timer_expired(&e->lifetime)) {
+      PRINTF("Exchange %u expired\n\r", e->mid);
+      ++exchanges_stats.expired;
+      exchange_free(e);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*- Internal API ------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+void
+coap_exchange_init(void)
+{
+  memb_init(&exchanges_memb);
+  list_init(exchanges_list);
+  exchanges_bytes = 0;
+  memset(&exchanges_stats, 0, sizeof(exchanges_stats));
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Answers a duplicate request from the cache
+ * \param addr Source address of the request
+ * \param port Source port of the request
+ * \param mid Message ID of the request
+ * \return 1 if the stored response was sent again, 0 otherwise
+ */
+int
+coap_exchange_replay(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
+{
+  coap_exchange_t *e;
+
+  exchange_purge();
+
+  for(e = list_head(exchanges_list); e; e = e->next) {
+    if(e->mid == mid && e->port == port && uip_ipaddr_cmp(&e->addr, addr)) {
+      PRINTF("Replaying response to duplicate %u\n\r", mid);
+      ++exchanges_stats.hits;
+      coap_send_message(addr, port, (uint8_t *)MMEM_PTR(&e->response),
+                        e->response.size);
+      return 1;
+    }
+  }
+  ++exchanges_stats.misses;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Keeps the response to a request for its exchange lifetime
+ * \param addr Source address of the request
+ * \param port Source port of the request
+ * \param mid Message ID of the request
+ * \param response The serialized response
+ * \param response_len Length of the response
+ */
+void
+coap_exchange_store(uip_ipaddr_t *addr, uint16_t port, uint16_t mid,
+                    const uint8_t *response, uint16_t response_len)
+{
+  coap_exchange_t *e;
+
+  if(response_len > COAP_EXCHANGE_BYTES) {
+    return;
+  }
+
+  /* make room by dropping the oldest exchanges */
+  while(list_head(exchanges_list)
+        && (exchanges_bytes + response_len > COAP_EXCHANGE_BYTES
+            || memb_numfree(&exchanges_memb) == 0)) {
+    ++exchanges_stats.evicted;
+    exchange_free(list_head(exchanges_list));
+  }
+
+  e = memb_alloc(&exchanges_memb);
+  if(e == NULL) {
+    return;
+  }
+  if(mmem_alloc(&e->response, response_len) == 0) {
+    memb_free(&exchanges_memb, e);
+    return;
+  }
+  memcpy(MMEM_PTR(&e->response), response, response_len);
+  exchanges_bytes += response_len;
+
+  uip_ipaddr_copy(&e->addr, addr);
+  e->port = port;
+  e->mid = mid;
+  timer_set(&e->lifetime, COAP_EXCHANGE_LIFETIME * bsp_get(E_BSP_GET_TRES));
+
+  list_add(exchanges_list, e);
+}
+/*---------------------------------------------------------------------------*/
+const coap_exchange_stats_t *
+coap_exchange_get_stats(void)
+{
+  return &exchanges_stats;
+}
+/*---------------------------------------------------------------------------*/
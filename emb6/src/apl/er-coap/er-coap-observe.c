@@ -37,6 +37,7 @@
  */
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include "er-coap-observe.h"
 #include "er-coap-transactions.h"
@@ -57,6 +58,66 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+
+/* observers hashed by resource, by client token and by last MID */
+static coap_observer_t *observers_by_url[COAP_OBSERVER_BUCKETS];
+static coap_observer_t *observers_by_token[COAP_OBSERVER_BUCKETS];
+static coap_observer_t *observers_by_mid[COAP_OBSERVER_BUCKETS];
+
+#define OBSERVER_HASH(h)        ((h) & (COAP_OBSERVER_BUCKETS - 1))
+#define OBSERVER_LINK(o, link)  (*(coap_observer_t **)((uint8_t *)(o) + (link)))
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+url_hash(const char *url)
+{
+  /* resources are told apart by their url pointer */
+  uintptr_t h = (uintptr_t)url;
+
+  return OBSERVER_HASH((h >> 2) ^ (h >> 6));
+}
+/*---------------------------------------------------------------------------*/
+static unsigned int
+token_hash(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
+           size_t token_len)
+{
+  unsigned int h = addr->u8[15] ^ port ^ (port >> 8);
+
+  while(token_len--) {
+    h = (h * 31) + token[token_len];
+  }
+  return OBSERVER_HASH(h);
+}
+/*---------------------------------------------------------------------------*/
+static unsigned int
+mid_hash(uint16_t mid)
+{
+  return OBSERVER_HASH(mid ^ (mid >> 8));
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_remove(coap_observer_t **bucket, coap_observer_t *o, size_t link)
+{
+  for(; *bucket; bucket = &OBSERVER_LINK(*bucket, link)) {
+    if(*bucket == o) {
+      *bucket = OBSERVER_LINK(o, link);
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+observer_set_mid(coap_observer_t *o, uint16_t mid)
+{
+  coap_observer_t **bucket;
+
+  index_remove(&observers_by_mid[mid_hash(o->last_mid)], o,
+               offsetof(coap_observer_t, mid_next));
+  o->last_mid = mid;
+  bucket = &observers_by_mid[mid_hash(mid)];
+  o->mid_next = *bucket;
+  *bucket = o;
+}
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -64,6 +125,8 @@ coap_observer_t *
 coap_add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
                   size_t token_len, const char *uri)
 {
+  coap_observer_t **bucket;
+
   /* Remove existing observe relationship, if any. */
   coap_remove_observer_by_uri(addr, port, uri);
 
@@ -81,6 +144,20 @@ coap_add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
            list_length(observers_list) + 1, COAP_MAX_OBSERVERS,
            o->url, o->token[0], o->token[1]);
     list_add(observers_list, o);
+
+    /* keep the order of registration for the notifications */
+    for(bucket = &observers_by_url[url_hash(uri)]; *bucket;
+        bucket = &(*bucket)->url_next);
+    o->url_next = NULL;
+    *bucket = o;
+
+    bucket = &observers_by_token[token_hash(addr, port, token, token_len)];
+    o->token_next = *bucket;
+    *bucket = o;
+
+    bucket = &observers_by_mid[mid_hash(o->last_mid)];
+    o->mid_next = *bucket;
+    *bucket = o;
   }
 
   return o;
@@ -94,6 +171,14 @@ coap_remove_observer(coap_observer_t *o)
   PRINTF("Removing observer for /%s [0x%02X%02X]\n", o->url, o->token[0],
          o->token[1]);
 
+  index_remove(&observers_by_url[url_hash(o->url)], o,
+               offsetof(coap_observer_t, url_next));
+  index_remove(&observers_by_token[token_hash(&o->addr, o->port, o->token,
+                                              o->token_len)], o,
+               offsetof(coap_observer_t, token_next));
+  index_remove(&observers_by_mid[mid_hash(o->last_mid)], o,
+               offsetof(coap_observer_t, mid_next));
+
   memb_free(&observers_memb, o);
   list_remove(observers_list, o);
 }
@@ -103,9 +188,10 @@ coap_remove_observer_by_client(uip_ipaddr_t *addr, uint16_t port)
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = (coap_observer_t *)list_head(observers_list); obs; obs = next) {
+    next = obs->next;
     PRINTF("Remove check client ");
     PRINT6ADDR(addr);
     PRINTF(":%u\n", port);
@@ -123,9 +209,11 @@ coap_remove_observer_by_token(uip_ipaddr_t *addr, uint16_t port,
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = observers_by_token[token_hash(addr, port, token, token_len)];
+      obs; obs = next) {
+    next = obs->token_next;
     PRINTF("Remove check Token 0x%02X%02X\n", token[0], token[1]);
     if(uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port
        && obs->token_len == token_len
@@ -143,9 +231,10 @@ coap_remove_observer_by_uri(uip_ipaddr_t *addr, uint16_t port,
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = (coap_observer_t *)list_head(observers_list); obs; obs = next) {
+    next = obs->next;
     PRINTF("Remove check URL %p\n", uri);
     if((addr == NULL
         || (uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port))
@@ -162,9 +251,10 @@ coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
 {
   int removed = 0;
   coap_observer_t *obs = NULL;
+  coap_observer_t *next;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
+  for(obs = observers_by_mid[mid_hash(mid)]; obs; obs = next) {
+    next = obs->mid_next;
     PRINTF("Remove check MID %u\n", mid);
     if(uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port
        && obs->last_mid == mid) {
@@ -177,56 +267,183 @@ coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+/*
+ * Finds the Observe option in a serialized message without token. The bytes
+ * before it and from its end on are the same for all observers.
+ */
+static int
+notification_split(const uint8_t *packet, uint16_t len, uint16_t *start,
+                   uint16_t *end)
+{
+  uint16_t i = COAP_HEADER_LEN;
+  unsigned int number = 0;
+  unsigned int delta;
+  unsigned int length;
+
+  while(i < len && packet[i] != 0xFF) {
+    *start = i;
+    delta = packet[i] >> 4;
+    length = packet[i] & 0x0F;
+    ++i;
+    if(delta == 13) {
+      delta = packet[i++] + 13;
+    } else if(delta == 14) {
+      delta = (packet[i] << 8) + packet[i + 1] + 269;
+      i += 2;
+    }
+    if(length == 13) {
+      length = packet[i++] + 13;
+    } else if(length == 14) {
+      length = (packet[i] << 8) + packet[i + 1] + 269;
+      i += 2;
+    }
+    i += length;
+    number += delta;
+
+    if(number == COAP_OPTION_OBSERVE) {
+      *end = i;
+      return 1;
+    } else if(number > COAP_OPTION_OBSERVE) {
+      break;
+    }
+  }
+  *start = *end = COAP_HEADER_LEN;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Writes the part of a notification that differs between observers: header,
+ * token and the options up to Observe. Returns its length.
+ */
+static uint16_t
+notification_head(uint8_t *buffer, const uint8_t *template, uint16_t start,
+                  uint16_t end, coap_message_type_t type, uint16_t mid,
+                  coap_observer_t *obs)
+{
+  uint16_t i = COAP_HEADER_LEN;
+  uint32_t observe;
+  uint8_t length = 0;
+
+  buffer[0] = (template[0] & COAP_HEADER_VERSION_MASK)
+    | (COAP_HEADER_TYPE_MASK & type << COAP_HEADER_TYPE_POSITION)
+    | (COAP_HEADER_TOKEN_LEN_MASK & obs->token_len);
+  buffer[1] = template[1];
+  buffer[2] = (uint8_t)(mid >> 8);
+  buffer[3] = (uint8_t)mid;
+
+  memcpy(buffer + i, obs->token, obs->token_len);
+  i += obs->token_len;
+  memcpy(buffer + i, template + COAP_HEADER_LEN, start - COAP_HEADER_LEN);
+  i += start - COAP_HEADER_LEN;
+
+  if(end > start) {
+    observe = (obs->obs_counter)++;
+    for(length = 4; length && !(observe >> ((length - 1) * 8)); --length);
+
+    /* the delta is the same as in the template */
+    buffer[i++] = (template[start] & 0xF0) | length;
+    while(length) {
+      buffer[i++] = (uint8_t)(observe >> (--length * 8));
+    }
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
 void
 coap_notify_observers(resource_t *resource)
 {
-  /* build notification */
+  /* the representation is rendered once for all observers */
+  static uint8_t template[COAP_MAX_PACKET_SIZE + 1];
   coap_packet_t notification[1]; /* this way the packet can be treated as pointer as usual */
-  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+  coap_shared_message_t *shared = NULL;
+  coap_transaction_t *transaction = NULL;
   coap_observer_t *obs = NULL;
+  coap_message_type_t type;
+  uint16_t template_len = 0;
+  uint16_t start = 0;
+  uint16_t end = 0;
+  uint16_t mid;
+  uint8_t *packet;
 
   PRINTF("Observe: Notification from %s\n", resource->url);
 
-  /* iterate over observers */
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
-      obs = obs->next) {
-    if(obs->url == resource->url) {     /* using RESOURCE url pointer as handle */
-      coap_transaction_t *transaction = NULL;
+  /* iterate over the observers of this resource */
+  for(obs = observers_by_url[url_hash(resource->url)]; obs;
+      obs = obs->url_next) {
+    if(obs->url != resource->url) {     /* using RESOURCE url pointer as handle */
+      continue;
+    }
 
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
+    if(template_len == 0) {
+      coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+      resource->get_handler(NULL, notification,
+                            template + COAP_MAX_HEADER_SIZE,
+                            REST_MAX_CHUNK_SIZE, NULL);
+      if(notification->code < BAD_REQUEST_4_00) {
+        coap_set_header_observe(notification, 0);
+      }
+      template_len = coap_serialize_message(notification, template);
+      if(template_len == 0) {
+        return;
+      }
+      notification_split(template, template_len, &start, &end);
+    }
 
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->addr, obs->port))) {
-        if(obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
-          PRINTF("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
-        }
+    PRINTF("           Observer ");
+    PRINT6ADDR(&obs->addr);
+    PRINTF(":%u\n", obs->port);
 
-        PRINTF("           Observer ");
-        PRINT6ADDR(&obs->addr);
-        PRINTF(":%u\n", obs->port);
+    if(obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
+      PRINTF("           Force Confirmable for\n");
+      type = COAP_TYPE_CON;
+    } else {
+      type = COAP_TYPE_NON;
+    }
 
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
+    if(type == COAP_TYPE_NON) {
+      /* nothing to keep, the notification is put together in place */
+      mid = coap_get_mid();
+      packet = &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN];
+      packet += notification_head(packet, template, start, end, type, mid,
+                                  obs);
+      memcpy(packet, template + end, template_len - end);
+      packet += template_len - end;
 
-        /* prepare response */
-        notification->mid = transaction->mid;
+      /* update last MID for RST matching */
+      observer_set_mid(obs, mid);
 
-        resource->get_handler(NULL, notification,
-                              transaction->packet + COAP_MAX_HEADER_SIZE,
-                              REST_MAX_CHUNK_SIZE, NULL);
+      coap_send_message(&obs->addr, obs->port,
+                        &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN],
+                        packet - &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN]);
 
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
+    } else if((transaction = coap_new_transaction(coap_get_mid(), &obs->addr,
+                                                  obs->port))) {
+      /* update last MID for RST matching */
+      observer_set_mid(obs, transaction->mid);
 
-        transaction->packet_len =
-          coap_serialize_message(notification, transaction->packet);
+      transaction->packet_len =
+        notification_head(transaction->packet, template, start, end, type,
+                          transaction->mid, obs);
 
-        coap_send_transaction(transaction);
+      /* confirmable notifications until acknowledged share the end */
+      if(shared == NULL) {
+        shared = coap_new_shared_message(template + end, template_len - end);
+      }
+      if(shared) {
+        coap_share_message(transaction, shared);
+      } else {
+        memcpy(transaction->packet + transaction->packet_len, template + end,
+               template_len - end);
+        transaction->packet_len += template_len - end;
       }
+
+      coap_send_transaction(transaction);
     }
   }
+
+  if(shared) {
+    coap_release_shared_message(shared);
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -38,11 +38,15 @@
  *
  */
 
+#include <stddef.h>
+#include <string.h>
+
 #include "etimer.h"
 #include "ctimer.h"
 #include "timer.h"
 #include "evproc.h"
 #include "memb.h"
+#include "mmem.h"
 #include "random.h"
 
 #include "tcpip.h"
@@ -66,17 +70,50 @@
 
 /*---------------------------------------------------------------------------*/
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
-LIST(transactions_list);
+MEMB(buffers_memb, coap_transaction_buffer_t, COAP_TRANSACTION_BUFFERS);
+MEMB(shared_memb, coap_shared_message_t, COAP_SHARED_MESSAGES);
+
+/* transactions hashed by MID, the number of buckets is a power of two */
+static coap_transaction_t *transactions_hash[COAP_TRANSACTION_BUCKETS];
+
+/* bytes of confirmable and shared messages kept in the managed memory */
+static uint16_t transactions_bytes;
+
+#define MID_HASH(mid)   (((mid) ^ ((mid) >> 8)) & (COAP_TRANSACTION_BUCKETS - 1))
 
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+static void
+transaction_store(coap_transaction_t *t)
+{
+  /* keep the build buffer if the message does not fit */
+  if(transactions_bytes + t->packet_len > COAP_TRANSACTION_BYTES
+     || mmem_alloc(&t->stored, t->packet_len) == 0) {
+    PRINTF("Keeping transaction %u in its build buffer\n\r", t->mid);
+    return;
+  }
+  memcpy(MMEM_PTR(&t->stored), t->packet, t->packet_len);
+  transactions_bytes += t->packet_len;
+
+  memb_free(&buffers_memb, t->packet);
+  t->packet = NULL;
+}
+/*---------------------------------------------------------------------------*/
 coap_transaction_t *
 coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
 {
   coap_transaction_t *t = memb_alloc(&transactions_memb);
+  coap_transaction_t **bucket;
 
   if(t) {
+    t->packet = memb_alloc(&buffers_memb);
+    if(t->packet == NULL) {
+      memb_free(&transactions_memb, t);
+      return NULL;
+    }
+    t->stored.size = 0;
+    t->shared = NULL;
     t->mid = mid;
     t->retrans_counter = 0;
 
@@ -84,7 +121,9 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
     t->addr = *addr;
     t->port = port;
 
-    list_add(transactions_list, t); /* list itself makes sure same element is not added twice */
+    bucket = &transactions_hash[MID_HASH(mid)];
+    t->next = *bucket;
+    *bucket = t;
   }
 
   return t;
@@ -93,12 +132,29 @@ coap_new_transaction(uint16_t mid, uip_ipaddr_t *addr, uint16_t port)
 void
 coap_send_transaction(coap_transaction_t *t)
 {
+  /*
+   * Sending may free managed memory, e.g. when the ND queue drops a packet,
+   * which moves the stored message. Do not use packet after sending.
+   */
+  uint8_t *packet = t->packet ? t->packet : (uint8_t *)MMEM_PTR(&t->stored);
+  uint8_t type = (COAP_HEADER_TYPE_MASK & packet[0]) >> COAP_HEADER_TYPE_POSITION;
+  uint8_t *message;
+
   PRINTF("\rSending transaction %u\n\r", t->mid);
 
-  coap_send_message(&t->addr, t->port, t->packet, t->packet_len);
+  if(t->shared) {
+    /* put the message together where the UDP payload goes */
+    message = &uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN];
+    memcpy(message, packet, t->packet_len);
+    memcpy(message + t->packet_len, MMEM_PTR(&t->shared->data),
+           t->shared->data.size);
+    coap_send_message(&t->addr, t->port, message,
+                      t->packet_len + t->shared->data.size);
+  } else {
+    coap_send_message(&t->addr, t->port, packet, t->packet_len);
+  }
 
-  if(COAP_TYPE_CON ==
-     ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION)) {
+  if(COAP_TYPE_CON == type) {
     if(t->retrans_counter < COAP_MAX_RETRANSMIT) {
       /* not timed out yet */
       PRINTF("Keeping transaction %u\n\r", t->mid);
@@ -111,6 +167,7 @@ coap_send_transaction(coap_transaction_t *t)
                                          COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
         PRINTF("Initial interval %d seconds\n\r",
                (int)t->retrans_timer.timer.interval / bsp_get(E_BSP_GET_TRES));
+        transaction_store(t);
       } else {
         t->retrans_timer.timer.interval <<= 1;  /* double */
         PRINTF("Doubled (%d) interval %d seconds\n\r", t->retrans_counter,
@@ -144,11 +201,29 @@ coap_send_transaction(coap_transaction_t *t)
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
+  coap_transaction_t **prev;
+
   if(t) {
     PRINTF("Freeing transaction %u: %p\n\r", t->mid, t);
 
     etimer_stop(&t->retrans_timer);
-    list_remove(transactions_list, t);
+
+    for(prev = &transactions_hash[MID_HASH(t->mid)]; *prev; prev = &(*prev)->next) {
+      if(*prev == t) {
+        *prev = t->next;
+        break;
+      }
+    }
+
+    if(t->packet) {
+      memb_free(&buffers_memb, t->packet);
+    } else if(t->stored.size) {
+      transactions_bytes -= t->stored.size;
+      mmem_free(&t->stored);
+    }
+    if(t->shared) {
+      coap_release_shared_message(t->shared);
+    }
     memb_free(&transactions_memb, t);
   }
 }
@@ -157,7 +232,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
   coap_transaction_t *t = NULL;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
+  for(t = transactions_hash[MID_HASH(mid)]; t; t = t->next) {
     if(t->mid == mid) {
       PRINTF("Found transaction for MID %u: %p\n\r", t->mid, t);
       return t;
@@ -166,17 +241,78 @@ coap_get_transaction_by_mid(uint16_t mid)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Retransmits the transaction whose timer expired
+ * \param retrans_timer The expired timer, as passed with the timer event
+ */
 void
-coap_check_transactions()
+coap_check_transaction(struct etimer *retrans_timer)
 {
-  coap_transaction_t *t = NULL;
+  coap_transaction_t *t = (coap_transaction_t *)((uint8_t *)retrans_timer -
+                          offsetof(coap_transaction_t, retrans_timer));
+  coap_transaction_t *i;
 
-  for(t = (coap_transaction_t *)list_head(transactions_list); t; t = t->next) {
-    if(etimer_expired(&t->retrans_timer)) {
-      ++(t->retrans_counter);
-      PRINTF("Retransmitting %u (%u)\n\r", t->mid, t->retrans_counter);
-      coap_send_transaction(t);
-    }
+  /* the event may still be queued for a transaction cleared meanwhile */
+  if(!memb_inmemb(&transactions_memb, t)) {
+    return;
+  }
+  for(i = transactions_hash[MID_HASH(t->mid)]; i && i != t; i = i->next);
+
+  if(i && etimer_expired(&t->retrans_timer)) {
+    ++(t->retrans_counter);
+    PRINTF("Retransmitting %u (%u)\n\r", t->mid, t->retrans_counter);
+    coap_send_transaction(t);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Keeps the common end of several messages in the managed memory
+ * \param data The bytes following the part specific to each message
+ * \param len Number of bytes
+ * \return The shared message holding one reference for the caller, or NULL
+ */
+coap_shared_message_t *
+coap_new_shared_message(const uint8_t *data, uint16_t len)
+{
+  coap_shared_message_t *s;
+
+  if(transactions_bytes + len > COAP_TRANSACTION_BYTES) {
+    return NULL;
+  }
+  s = memb_alloc(&shared_memb);
+  if(s == NULL) {
+    return NULL;
+  }
+  if(mmem_alloc(&s->data, len) == 0) {
+    memb_free(&shared_memb, s);
+    return NULL;
+  }
+  memcpy(MMEM_PTR(&s->data), data, len);
+  transactions_bytes += len;
+  s->refs = 1;
+
+  return s;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Attaches a shared message to a transaction and takes a reference
+ * \param t The transaction, its packet holds the part specific to it
+ * \param s The common end sent after the packet of t
+ */
+void
+coap_share_message(coap_transaction_t *t, coap_shared_message_t *s)
+{
+  ++s->refs;
+  t->shared = s;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_release_shared_message(coap_shared_message_t *s)
+{
+  if(--s->refs == 0) {
+    transactions_bytes -= s->data.size;
+    mmem_free(&s->data);
+    memb_free(&shared_memb, s);
   }
 }
 /*---------------------------------------------------------------------------*/
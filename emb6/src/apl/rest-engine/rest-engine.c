@@ -44,6 +44,9 @@
 #include "er-coap.h"
 #include "rest-engine.h"
 #include "etimer.h"
+#include "memb.h"
+
+#include <string.h>
 
 
 #define DEBUG DEBUG_NONE
@@ -66,6 +69,25 @@
 /* initialize the PERIODIC_RESOURCE timers, which will be handled by this process. */
 static periodic_resource_t *periodic_resource = NULL;
 
+/*
+ * URI-path trie used for the dispatch. Each node holds one path segment
+ * together with its precomputed length, children are kept in a sibling list.
+ * The resources themselves stay in restful_services for link-format output.
+ */
+struct rest_trie_node {
+  struct rest_trie_node *sibling;
+  struct rest_trie_node *child;
+  const char *seg;
+  uint16_t seg_len;
+  resource_t *resource;
+};
+
+MEMB(trie_memb, struct rest_trie_node, REST_TRIE_NODES);
+static struct rest_trie_node trie_root;
+
+/* set when a resource did not fit into the trie and needs the linear scan */
+static uint8_t trie_overflow;
+
 void _rest_et_callback(c_event_t c_event, p_data_t p_data);
 
 /*---------------------------------------------------------------------------*/
@@ -82,12 +104,119 @@ rest_init_engine(void)
 {
   list_init(restful_services);
 
+  memb_init(&trie_memb);
+  memset(&trie_root, 0, sizeof(trie_root));
+  trie_overflow = 0;
+
   REST.set_service_callback(rest_invoke_restful_service);
 
   /* Start the RESTful server implementation. */
   REST.init();
 
 
+}
+/*---------------------------------------------------------------------------*/
+static struct rest_trie_node *
+trie_find_child(struct rest_trie_node *node, const char *seg, uint16_t len)
+{
+  for(node = node->child; node; node = node->sibling) {
+    if(node->seg_len == len && memcmp(node->seg, seg, len) == 0) {
+      return node;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+trie_insert(resource_t *resource)
+{
+  struct rest_trie_node *node = &trie_root;
+  struct rest_trie_node *child;
+  struct rest_trie_node *branch = NULL;
+  struct rest_trie_node *tail = NULL;
+  const char *seg = resource->url;
+  const char *end = seg + strlen(seg);
+  const char *next = end;
+
+  /* the empty path is the root itself */
+  if(seg < end) {
+    do {
+      for(next = seg; next < end && *next != '/'; ++next);
+
+      /* below the first missing segment every node is new */
+      child = branch ? NULL : trie_find_child(node, seg, next - seg);
+      if(child == NULL) {
+        child = memb_alloc(&trie_memb);
+        if(child == NULL) {
+          /* the new branch is not linked yet, so release it as a whole */
+          while(branch) {
+            child = branch->child;
+            memb_free(&trie_memb, branch);
+            branch = child;
+          }
+          return 0;
+        }
+        child->seg = seg;
+        child->seg_len = next - seg;
+        child->sibling = NULL;
+        child->child = NULL;
+        child->resource = NULL;
+        if(tail) {
+          tail->child = child;
+        } else {
+          branch = child;
+        }
+        tail = child;
+      } else {
+        node = child;
+      }
+      seg = next + 1;
+    } while(next < end);
+  }
+
+  if(branch) {
+    branch->sibling = node->child;
+    node->child = branch;
+    node = tail;
+  }
+
+  /* the first resource registered under a path keeps it */
+  if(node->resource == NULL) {
+    node->resource = resource;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Returns the resource registered under exactly this path. The deepest
+ * HAS_SUB_RESOURCES resource above it is passed back through parent.
+ */
+static resource_t *
+trie_lookup(const char *url, int len, resource_t **parent)
+{
+  struct rest_trie_node *node = &trie_root;
+  const char *end = url + len;
+  const char *next;
+
+  *parent = NULL;
+  if(len <= 0) {
+    return trie_root.resource;
+  }
+
+  do {
+    if(node->resource && (node->resource->flags & HAS_SUB_RESOURCES)) {
+      *parent = node->resource;
+    }
+    for(next = url; next < end && *next != '/'; ++next);
+
+    node = trie_find_child(node, url, next - url);
+    if(node == NULL) {
+      return NULL;
+    }
+    url = next + 1;
+  } while(next < end);
+
+  return node->resource;
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -105,6 +234,10 @@ rest_activate_resource(resource_t *resource, char *path)
   resource->url = path;
   struct periodic_resource_s * periodic = resource->un_handler.periodic;
   list_add(restful_services, resource);
+  if(!trie_insert(resource)) {
+    PRINTF("Trie full, /%s falls back to linear dispatch\n\r", resource->url);
+    trie_overflow = 1;
+  }
 
   PRINTF("Activating: %s\n\r", resource->url);
 
@@ -143,41 +276,66 @@ rest_invoke_restful_service(void *request, void *response, uint8_t *buffer,
   uint8_t allowed = 1;
 
   resource_t *resource = NULL;
+  resource_t *parent;
   const char *url = NULL;
+  int url_len;
+  int res_len;
+  int parent_len;
 
-  for(resource = (resource_t *)list_head(restful_services);
-      resource; resource = resource->next) {
-
-    /* if the web service handles that kind of requests and urls matches */
-    if((REST.get_url(request, &url) == strlen(resource->url)
-        || (REST.get_url(request, &url) > strlen(resource->url)
-            && (resource->flags & HAS_SUB_RESOURCES)))
-       && strncmp(resource->url, url, strlen(resource->url)) == 0) {
-      found = 1;
-      rest_resource_flags_t method = REST.get_method_type(request);
-
-      PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
-             (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
-                               offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
+  url_len = REST.get_url(request, &url);
+  resource = trie_lookup(url, url_len, &parent);
+
+  /*
+   * Resources which did not fit into the trie may match exactly or sit
+   * deeper below than the parent found in the trie, so check them first.
+   */
+  if(resource == NULL && trie_overflow) {
+    parent_len = parent ? (int)strlen(parent->url) : -1;
+    for(resource = (resource_t *)list_head(restful_services);
+        resource; resource = resource->next) {
+      res_len = strlen(resource->url);
+      if(url_len == res_len && strncmp(resource->url, url, res_len) == 0) {
+        break;
       }
-      break;
+      if(url_len > res_len && res_len > parent_len
+         && (resource->flags & HAS_SUB_RESOURCES) && url[res_len] == '/'
+         && strncmp(resource->url, url, res_len) == 0) {
+        parent = resource;
+        parent_len = res_len;
+      }
+    }
+  }
+
+  /* the deepest parent handles requests without an exact match */
+  if(resource == NULL) {
+    resource = parent;
+  }
+
+  /* if the web service handles that kind of requests and urls matches */
+  if(resource) {
+    rest_resource_flags_t method = REST.get_method_type(request);
+    found = 1;
+
+    PRINTF("/%s, method %u, resource->flags %u\n", resource->url,
+           (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
+                               offset);
+    } else {
+      allowed = 0;
+      REST.set_response_status(response, REST.status.METHOD_NOT_ALLOWED);
     }
   }
   if(!found) {
@@ -66,6 +66,14 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_HASH
+/* Hash index over the key pool. A slot holds the neighbor index plus one,
+ * zero marks a free slot. With a load factor below one half a free slot
+ * always terminates the probe sequence. */
+#define NBR_HASH_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS + 1)
+static uint16_t nbr_hash[NBR_HASH_SIZE];
+#endif /* NBR_TABLE_HASH */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -108,17 +116,81 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_HASH
+/*---------------------------------------------------------------------------*/
+/* Get the home slot of a link-layer address in the hash index */
+static int
+hash_from_lladdr(const linkaddr_t *lladdr)
+{
+  uint32_t h = 2166136261u;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h = (h ^ lladdr->u8[i]) * 16777619u;
+  }
+  return h % NBR_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a neighbor to the hash index, its lladdr must already be set */
+static void
+hash_add(int index)
+{
+  int i = hash_from_lladdr(&key_from_index(index)->lladdr);
+  while(nbr_hash[i] != 0) {
+    i = i + 1 < NBR_HASH_SIZE ? i + 1 : 0;
+  }
+  nbr_hash[i] = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a neighbor from the hash index using backward shift deletion */
+static void
+hash_remove(int index)
+{
+  int i = hash_from_lladdr(&key_from_index(index)->lladdr);
+  int j;
+  int k;
+  while(nbr_hash[i] != index + 1) {
+    if(nbr_hash[i] == 0) {
+      return;
+    }
+    i = i + 1 < NBR_HASH_SIZE ? i + 1 : 0;
+  }
+  for(j = i + 1 < NBR_HASH_SIZE ? i + 1 : 0; nbr_hash[j] != 0;
+      j = j + 1 < NBR_HASH_SIZE ? j + 1 : 0) {
+    k = hash_from_lladdr(&key_from_index(nbr_hash[j] - 1)->lladdr);
+    /* Move slot j into the hole unless its home slot lies cyclically in (i, j] */
+    if((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+      nbr_hash[i] = nbr_hash[j];
+      i = j;
+    }
+  }
+  nbr_hash[i] = 0;
+}
+#endif /* NBR_TABLE_HASH */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
+#if NBR_TABLE_HASH
+  int i;
+#else /* NBR_TABLE_HASH */
   nbr_table_key_t *key;
+#endif /* NBR_TABLE_HASH */
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_HASH
+  i = hash_from_lladdr(lladdr);
+  while(nbr_hash[i] != 0) {
+    if(linkaddr_cmp(lladdr, &key_from_index(nbr_hash[i] - 1)->lladdr)) {
+      return nbr_hash[i] - 1;
+    }
+    i = i + 1 < NBR_HASH_SIZE ? i + 1 : 0;
+  }
+  return -1;
+#else /* NBR_TABLE_HASH */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -127,6 +199,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_HASH */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -222,6 +295,9 @@ nbr_table_allocate(void)
       used_map[index_from_key(least_used_key)] = 0;
       /* Remove neighbor from list */
       list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_HASH
+      hash_remove(index_from_key(least_used_key));
+#endif /* NBR_TABLE_HASH */
       /* Return associated key */
       return least_used_key;
     }
@@ -302,6 +378,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr)
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_HASH
+    hash_add(index);
+#endif /* NBR_TABLE_HASH */
   }
 
   /* Get item in the current table */
@@ -352,3 +431,23 @@ nbr_table_get_lladdr(nbr_table_t *table, const void *item)
   nbr_table_key_t *key = key_from_item(table, item);
   return key != NULL ? &key->lladdr : NULL;
 }
+/*---------------------------------------------------------------------------*/
+/* Change link-layer address of an item. The new address is shared by all
+ * tables using the neighbor. Use this instead of writing through
+ * nbr_table_get_lladdr(), so the lladdr index stays consistent */
+int
+nbr_table_set_lladdr(nbr_table_t *table, nbr_table_item_t *item, const linkaddr_t *lladdr)
+{
+  nbr_table_key_t *key = key_from_item(table, item);
+  if(key == NULL || lladdr == NULL) {
+    return 0;
+  }
+#if NBR_TABLE_HASH
+  hash_remove(index_from_key(key));
+#endif /* NBR_TABLE_HASH */
+  linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_HASH
+  hash_add(index_from_key(key));
+#endif /* NBR_TABLE_HASH */
+  return 1;
+}
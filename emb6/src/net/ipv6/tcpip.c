@@ -52,6 +52,7 @@
 #include "etimer.h"
 #include "uip-split.h"
 #include "uip-packetqueue.h"
+#include "packetbuf.h"
 
 #if NETSTACK_CONF_WITH_IPV6
 #include "uip-nd6.h"
@@ -116,6 +117,26 @@ static struct internal_state {
 //  PACKET_INPUT
 //};
 
+#if UIP_PACKETQUEUE_NUM > 0
+/*
+ * Received packets are parked in packet buffers and processed by a
+ * later event, so the radio driver gets back the control before the
+ * packet is processed and the replies are sent. The link layer
+ * attributes of a packet are kept as RPL reads the sender from them.
+ */
+struct tcpip_rx {
+  struct uip_packetqueue_handle handle;
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+};
+
+static struct tcpip_rx rx_queue[UIP_PACKETQUEUE_NUM];
+static uint8_t rx_head;
+static uint8_t rx_count;
+
+static void rx_dequeue(void);
+#endif /* UIP_PACKETQUEUE_NUM > 0 */
+
 /* Called on IP packet output. */
 #if NETSTACK_CONF_WITH_IPV6
 
@@ -492,15 +513,89 @@ eventhandler(c_event_t ev, p_data_t data)
 #endif /* UIP_UDP */
 
     case EVENT_TYPE_PCK_INPUT:
+#if UIP_PACKETQUEUE_NUM > 0
+      if(data == rx_queue) {
+        rx_dequeue();
+        break;
+      }
+#endif /* UIP_PACKETQUEUE_NUM > 0 */
       packet_input();
       break;
   };
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_PACKETQUEUE_NUM > 0
+static uint8_t
+rx_enqueue(void)
+{
+  struct tcpip_rx *rx;
+
+  if(rx_count == UIP_PACKETQUEUE_NUM) {
+    return 0;
+  }
+
+  rx = &rx_queue[(rx_head + rx_count) % UIP_PACKETQUEUE_NUM];
+  if(uip_packetqueue_alloc(&rx->handle, 0) == NULL) {
+    return 0;
+  }
+  memcpy(uip_packetqueue_buf(&rx->handle), UIP_IP_BUF, uip_len);
+  uip_packetqueue_set_buflen(&rx->handle, uip_len);
+  packetbuf_attr_copyto(rx->attrs, rx->addrs);
+  rx_count++;
+
+  evproc_putEvent(E_EVPROC_TAIL, EVENT_TYPE_PCK_INPUT, rx_queue);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rx_dequeue(void)
+{
+  struct tcpip_rx *rx;
+
+  if(rx_count == 0) {
+    return;
+  }
+
+  rx = &rx_queue[rx_head];
+  rx_head = (rx_head + 1) % UIP_PACKETQUEUE_NUM;
+  rx_count--;
+
+  uip_len = uip_packetqueue_buflen(&rx->handle);
+  memcpy(UIP_IP_BUF, uip_packetqueue_buf(&rx->handle), uip_len);
+  uip_packetqueue_free(&rx->handle);
+  packetbuf_clear();
+  packetbuf_attr_copyfrom(rx->attrs, rx->addrs);
+
+  /* One packet per event, so the radio events are served in between */
+  if(rx_count > 0) {
+    evproc_putEvent(E_EVPROC_TAIL, EVENT_TYPE_PCK_INPUT, rx_queue);
+  }
+
+  packet_input();
+  uip_len = 0;
+#if NETSTACK_CONF_WITH_IPV6
+  uip_ext_len = 0;
+#endif /*NETSTACK_CONF_WITH_IPV6*/
+}
+#endif /* UIP_PACKETQUEUE_NUM > 0 */
+/*---------------------------------------------------------------------------*/
 void
 tcpip_input(void)
 {
+#if UIP_PACKETQUEUE_NUM > 0
+  if(!rx_enqueue()) {
+    if(rx_count > 0) {
+      /* The packet must not overtake the queued ones */
+      PRINTF("tcpip_input: receive queue full, dropping packet\n\r");
+      UIP_STAT(++uip_stat.ip.drop);
+    } else {
+      /* Process the packet right away if no packet buffer is left */
+      evproc_putEvent(E_EVPROC_EXEC,EVENT_TYPE_PCK_INPUT,NULL);
+    }
+  }
+#else
     evproc_putEvent(E_EVPROC_EXEC,EVENT_TYPE_PCK_INPUT,NULL);
+#endif /* UIP_PACKETQUEUE_NUM > 0 */
 //    evproc_pushEvent(EVENT_TYPE_PCK_INPUT, NULL);
   //process_post_synch(&tcpip_process, PACKET_INPUT, NULL);
   uip_len = 0;
@@ -630,10 +725,7 @@ tcpip_ipv6_output(void)
       } else {
 #if UIP_CONF_IPV6_QUEUE_PKT
         /* Copy outgoing pkt in the queuing buffer for later transmit. */
-        if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-          memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-          uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-        }
+        uip_packetqueue_enqueue(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME);
 #endif
       /* RFC4861, 7.2.2:
        * "If the source address of the packet prompting the solicitation is the
@@ -658,10 +750,7 @@ tcpip_ipv6_output(void)
 #if UIP_CONF_IPV6_QUEUE_PKT
         /* Copy outgoing pkt in the queuing buffer for later transmit and set
            the destination nbr to nbr. */
-        if(uip_packetqueue_alloc(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME) != NULL) {
-          memcpy(uip_packetqueue_buf(&nbr->packethandle), UIP_IP_BUF, uip_len);
-          uip_packetqueue_set_buflen(&nbr->packethandle, uip_len);
-        }
+        uip_packetqueue_enqueue(&nbr->packethandle, UIP_DS6_NBR_PACKET_LIFETIME);
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
         uip_len = 0;
         return;
@@ -685,10 +774,7 @@ tcpip_ipv6_output(void)
        * NA after sendiong a NS, you receive a NS with SLLAO: the entry moves
        * to STALE, and you must both send a NA and the queued packet.
        */
-      if(uip_packetqueue_buflen(&nbr->packethandle) != 0) {
-        uip_len = uip_packetqueue_buflen(&nbr->packethandle);
-        memcpy(UIP_IP_BUF, uip_packetqueue_buf(&nbr->packethandle), uip_len);
-        uip_packetqueue_free(&nbr->packethandle);
+      while(uip_packetqueue_dequeue(&nbr->packethandle) != 0) {
         tcpip_output(uip_ds6_nbr_get_ll(nbr));
       }
 #endif /*UIP_CONF_IPV6_QUEUE_PKT*/
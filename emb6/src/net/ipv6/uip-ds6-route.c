@@ -43,6 +43,7 @@
 #include "uip.h"
 
 #include "clist.h"
+#include "dlist.h"
 #include "memb.h"
 #include "nbr-table.h"
 
@@ -59,7 +60,7 @@ MEMB(neighborroutememb, struct uip_ds6_route_neighbor_route, UIP_DS6_ROUTE_NB);
 /* Each route is repressented by a uip_ds6_route_t structure and
    memory for each route is allocated from the routememb memory
    block. These routes are maintained on the routelist. */
-LIST(routelist);
+DLIST(routelist);
 MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 
 /* Default routes are held on the defaultrouterlist and their
@@ -79,6 +80,209 @@ static int num_routes = 0;
 
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_TRIE
+/* Node of the route index. A node either holds a route with exactly
+   this prefix, or it is a branch with both children present. Hence N
+   routes never need more than 2N - 1 nodes. */
+struct route_trie {
+  struct route_trie *child[2];
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+};
+
+MEMB(routetriememb, struct route_trie, 2 * UIP_DS6_ROUTE_NB);
+static struct route_trie *route_trie_root;
+static uint32_t route_use_counter;
+/*---------------------------------------------------------------------------*/
+static uint8_t
+route_trie_bit(const uip_ipaddr_t *addr, uint8_t bit)
+{
+  return (addr->u8[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the index of the first bit in [from, to) in which a and b
+   differ, or to if they are equal in this range. */
+static uint8_t
+route_trie_diff(const uip_ipaddr_t *a, const uip_ipaddr_t *b,
+                uint8_t from, uint8_t to)
+{
+  uint8_t i;
+  uint8_t x;
+
+  for(i = from >> 3; (i << 3) < to; i++) {
+    x = a->u8[i] ^ b->u8[i];
+    if(i == (from >> 3)) {
+      /* Ignore the bits in front of from */
+      x &= 0xff >> (from & 7);
+    }
+    if(x != 0) {
+      uint8_t bit = i << 3;
+      while(!(x & 0x80)) {
+        x <<= 1;
+        bit++;
+      }
+      return bit < to ? bit : to;
+    }
+  }
+  return to;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie *
+route_trie_new(const uip_ipaddr_t *prefix, uint8_t length,
+               uip_ds6_route_t *route)
+{
+  struct route_trie *n = memb_alloc(&routetriememb);
+  if(n != NULL) {
+    n->child[0] = NULL;
+    n->child[1] = NULL;
+    n->route = route;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_trie_lookup(const uip_ipaddr_t *addr)
+{
+  struct route_trie *n;
+  uip_ds6_route_t *found = NULL;
+  uint8_t matched = 0;
+
+  for(n = route_trie_root; n != NULL; n = n->child[route_trie_bit(addr, matched)]) {
+    /* Only the bits below this node have to be compared */
+    if(route_trie_diff(addr, &n->prefix, matched, n->length) != n->length) {
+      break;
+    }
+    matched = n->length;
+    if(n->route != NULL) {
+      found = n->route;
+    }
+    if(matched == 128) {
+      break;
+    }
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie **
+route_trie_find(const uip_ipaddr_t *prefix, uint8_t length,
+                struct route_trie ***parent)
+{
+  struct route_trie **link = &route_trie_root;
+  uint8_t matched = 0;
+
+  *parent = NULL;
+  while(*link != NULL &&
+        route_trie_diff(prefix, &(*link)->prefix, matched,
+                        (*link)->length) == (*link)->length &&
+        (*link)->length <= length) {
+    if((*link)->length == length) {
+      return link;
+    }
+    matched = (*link)->length;
+    *parent = link;
+    link = &(*link)->child[route_trie_bit(prefix, matched)];
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_trie_get(const uip_ipaddr_t *prefix, uint8_t length)
+{
+  struct route_trie **parent;
+  struct route_trie **link = route_trie_find(prefix, length, &parent);
+
+  return link != NULL ? (*link)->route : NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+route_trie_add(uip_ds6_route_t *route)
+{
+  struct route_trie **link = &route_trie_root;
+  struct route_trie *n;
+  struct route_trie *leaf;
+  struct route_trie *branch;
+  uint8_t matched = 0;
+  uint8_t diff;
+
+  while((n = *link) != NULL) {
+    diff = route_trie_diff(&route->ipaddr, &n->prefix, matched,
+                           route->length < n->length ?
+                           route->length : n->length);
+    if(diff < n->length) {
+      leaf = route_trie_new(&route->ipaddr, route->length, route);
+      if(leaf == NULL) {
+        return 0;
+      }
+      if(diff == route->length) {
+        /* The new prefix covers this node */
+        leaf->child[route_trie_bit(&n->prefix, diff)] = n;
+        *link = leaf;
+        return 1;
+      }
+      /* Both prefixes split up at diff */
+      branch = route_trie_new(&route->ipaddr, diff, NULL);
+      if(branch == NULL) {
+        memb_free(&routetriememb, leaf);
+        return 0;
+      }
+      branch->child[route_trie_bit(&route->ipaddr, diff)] = leaf;
+      branch->child[route_trie_bit(&n->prefix, diff)] = n;
+      *link = branch;
+      return 1;
+    }
+    if(n->length == route->length) {
+      n->route = route;
+      return 1;
+    }
+    matched = n->length;
+    link = &n->child[route_trie_bit(&route->ipaddr, matched)];
+  }
+
+  *link = route_trie_new(&route->ipaddr, route->length, route);
+  return *link != NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Removes a node without route and with at most one child */
+static void
+route_trie_collapse(struct route_trie **link)
+{
+  struct route_trie *n = *link;
+
+  *link = n->child[0] != NULL ? n->child[0] : n->child[1];
+  memb_free(&routetriememb, n);
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_trie_rm(uip_ds6_route_t *route)
+{
+  struct route_trie **parent;
+  struct route_trie **link;
+  struct route_trie *n;
+
+  link = route_trie_find(&route->ipaddr, route->length, &parent);
+  if(link == NULL || (*link)->route != route) {
+    return;
+  }
+
+  n = *link;
+  n->route = NULL;
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    /* Still needed as branch */
+    return;
+  }
+  route_trie_collapse(link);
+
+  /* The parent may have become a branch with a single child */
+  if(parent != NULL && (*parent)->route == NULL &&
+     ((*parent)->child[0] == NULL || (*parent)->child[1] == NULL)) {
+    route_trie_collapse(parent);
+  }
+}
+#endif /* UIP_DS6_ROUTE_TRIE */
+/*---------------------------------------------------------------------------*/
 #if DEBUG != DEBUG_NONE
 static void
 assert_nbr_routes_list_sane(void)
@@ -148,13 +352,19 @@ void
 uip_ds6_route_init(void)
 {
   memb_init(&routememb);
-  list_init(routelist);
+  dlist_init(routelist);
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 
   memb_init(&defaultroutermemb);
   list_init(defaultrouterlist);
 
+#if UIP_DS6_ROUTE_TRIE
+  memb_init(&routetriememb);
+  route_trie_root = NULL;
+  route_use_counter = 0;
+#endif
+
 #if UIP_DS6_NOTIFICATIONS
   list_init(notificationlist);
 #endif
@@ -184,14 +394,14 @@ uip_ds6_route_nexthop(uip_ds6_route_t *route)
 uip_ds6_route_t *
 uip_ds6_route_head(void)
 {
-    return list_head(routelist);
+    return dlist_head(routelist);
 }
 /*---------------------------------------------------------------------------*/
 uip_ds6_route_t *
 uip_ds6_route_next(uip_ds6_route_t *r)
 {
   if(r != NULL) {
-    uip_ds6_route_t *n = list_item_next(r);
+    uip_ds6_route_t *n = dlist_item_next(r);
     return n;
   }
 
@@ -207,15 +417,23 @@ uip_ds6_route_num_routes(void)
 uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n\r");
 
 
+#if UIP_DS6_ROUTE_TRIE
+  found_route = route_trie_lookup(addr);
+  if(found_route != NULL) {
+    found_route->last_used = ++route_use_counter;
+  }
+#else
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -233,6 +451,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
             }
         }
   }
+#endif /* UIP_DS6_ROUTE_TRIE */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -244,14 +463,15 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n\r");
   }
 
-  if(found_route != NULL && found_route != list_head(routelist)) {
+#if !UIP_DS6_ROUTE_TRIE
+  if(found_route != NULL && found_route != dlist_head(routelist)) {
       /* If we found a route, we put it at the start of the routeslist
          list. The list is ordered by how recently we looked them up:
          the least recently used route will be at the end of the
          list - for fast lookups (assuming multiple packets to the same node). */
-      list_remove(routelist, found_route);
-      list_push(routelist, found_route);
+      dlist_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_TRIE */
 
   return found_route;
 }
@@ -303,6 +523,13 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
     uip_ds6_route_rm(r);
     }
+#if UIP_DS6_ROUTE_TRIE
+    /* The index holds a single route per prefix */
+    r = route_trie_get(ipaddr, length);
+    if(r != NULL) {
+      uip_ds6_route_rm(r);
+    }
+#endif
     {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one. We first need to
@@ -314,7 +541,18 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
              least recently used route is the first route on the list. */
         uip_ds6_route_t *oldest;
 
-        oldest = list_tail(routelist); /* uip_ds6_route_head(); */
+#if UIP_DS6_ROUTE_TRIE
+        uip_ds6_route_t *it;
+
+        oldest = dlist_head(routelist);
+        for(it = oldest; it != NULL; it = dlist_item_next(it)) {
+          if((int32_t)(it->last_used - oldest->last_used) < 0) {
+            oldest = it;
+          }
+        }
+#else
+        oldest = dlist_tail(routelist); /* uip_ds6_route_head(); */
+#endif
         PRINTF("uip_ds6_route_add: dropping route to ");
         PRINT6ADDR(&oldest->ipaddr);
         PRINTF("\n");
@@ -362,7 +600,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
     /* add new routes first - assuming that there is a reason to add this
            and that there is a packet coming soon. */
-    list_push(routelist, r);
+    dlist_push(routelist, r);
 
     nbrr = memb_alloc(&neighborroutememb);
     if(nbrr == NULL) {
@@ -385,6 +623,14 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
 
+#if UIP_DS6_ROUTE_TRIE
+  r->last_used = ++route_use_counter;
+  if(!route_trie_add(r)) {
+    /* This should not happen, there are two trie nodes per route. */
+    PRINTF("uip_ds6_route_add: could not index route\n");
+  }
+#endif
+
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
 #endif
@@ -421,7 +667,10 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINTF("\n\r");
 
     /* Remove the route from the route list */
-    list_remove(routelist, route);
+    dlist_remove(routelist, route);
+#if UIP_DS6_ROUTE_TRIE
+    route_trie_rm(route);
+#endif
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
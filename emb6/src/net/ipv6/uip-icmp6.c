@@ -123,6 +123,7 @@ echo_request_input(void)
 #if UIP_CONF_IPV6_RPL
   uint8_t temp_ext_len;
 #endif /* UIP_CONF_IPV6_RPL */
+  uint16_t icmpchksum;
   /*
    * we send an echo reply. It is trivial if there was no extension
    * headers in the request otherwise we need to remove the extension
@@ -134,12 +135,27 @@ echo_request_input(void)
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
   PRINTF("\n");
 
+  /*
+   * The reply carries the same data as the request, so only the fields
+   * which change are updated in the checksum of the request. The
+   * payload does not have to be summed again.
+   */
+  icmpchksum = uip_chksum_remove(UIP_ICMP_BUF->icmpchksum,
+                                 &UIP_ICMP_BUF->type, 2);
+
   /* IP header */
   UIP_IP_BUF->ttl = uip_ds6_if.cur_hop_limit;
 
   if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)){
+    /* Swapping the addresses keeps the sum, replacing one does not */
+    icmpchksum = uip_chksum_remove(icmpchksum,
+                                   (uint8_t *)&UIP_IP_BUF->srcipaddr,
+                                   2 * sizeof(uip_ipaddr_t));
     uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &UIP_IP_BUF->srcipaddr);
     uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+    icmpchksum = uip_chksum_add(icmpchksum,
+                                (uint8_t *)&UIP_IP_BUF->srcipaddr,
+                                2 * sizeof(uip_ipaddr_t));
   } else {
     uip_ipaddr_copy(&tmp_ipaddr, &UIP_IP_BUF->srcipaddr);
     uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
@@ -192,8 +208,8 @@ echo_request_input(void)
   /* Note: now UIP_ICMP_BUF points to the beginning of the echo reply */
   UIP_ICMP_BUF->type = ICMP6_ECHO_REPLY;
   UIP_ICMP_BUF->icode = 0;
-  UIP_ICMP_BUF->icmpchksum = 0;
-  UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+  UIP_ICMP_BUF->icmpchksum = uip_chksum_add(icmpchksum,
+                                            &UIP_ICMP_BUF->type, 2);
 
   PRINTF("Sending Echo Reply to");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
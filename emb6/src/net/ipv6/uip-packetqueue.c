@@ -3,15 +3,27 @@
  *         A brief description the file
  */
 #include <stdio.h>
+#include <string.h>
 
 #include "uip.h"
 
 #include "memb.h"
+#include "dlist.h"
 
 #include "uip-packetqueue.h"
 
-#define MAX_NUM_QUEUED_PACKETS 1
-MEMB(packets_memb, struct uip_packetqueue_packet, MAX_NUM_QUEUED_PACKETS);
+#define UIP_IP_BUF                ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+MEMB(packets_memb, struct uip_packetqueue_packet, UIP_PACKETQUEUE_NUM);
+
+MEMB(entries_memb, struct uip_packetqueue_entry, UIP_PACKETQUEUE_ENTRIES);
+/* All queued packets, the least recently queued first */
+DLIST(entries_list);
+/* Bytes of all queued packets */
+static uint16_t queued_bytes;
+/* Expires with the first packet whose lifetime is over */
+static struct ctimer queue_timer;
+static struct uip_packetqueue_stats stats;
 
 #define DEBUG DEBUG_NONE
 #if DEBUG
@@ -32,11 +44,73 @@ packet_timedout(void *ptr)
   h->packet = NULL;
 }
 /*---------------------------------------------------------------------------*/
+static void
+entry_remove(struct uip_packetqueue_entry *e)
+{
+  struct uip_packetqueue_handle *h = e->handle;
+  struct uip_packetqueue_entry **pp;
+
+  for(pp = &h->queue; *pp != NULL; pp = &(*pp)->qnext) {
+    if(*pp == e) {
+      *pp = e->qnext;
+      h->queue_len--;
+      break;
+    }
+  }
+  dlist_remove(entries_list, e);
+  queued_bytes -= e->mem.size;
+  mmem_free(&e->mem);
+  memb_free(&entries_memb, e);
+}
+/*---------------------------------------------------------------------------*/
+static void queue_timedout(void *ptr);
+
+static void
+queue_timer_set(void)
+{
+  struct uip_packetqueue_entry *e;
+  clock_time_t remaining;
+  clock_time_t next = 0;
+
+  for(e = dlist_head(entries_list); e != NULL; e = dlist_item_next(e)) {
+    remaining = timer_expired(&e->lifetimer) ? 0 :
+                timer_remaining(&e->lifetimer);
+    if(e == dlist_head(entries_list) || remaining < next) {
+      next = remaining;
+    }
+  }
+
+  if(dlist_head(entries_list) != NULL) {
+    ctimer_set(&queue_timer, next, queue_timedout, NULL);
+  } else {
+    ctimer_stop(&queue_timer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_timedout(void *ptr)
+{
+  struct uip_packetqueue_entry *e;
+  struct uip_packetqueue_entry *next;
+
+  for(e = dlist_head(entries_list); e != NULL; e = next) {
+    next = dlist_item_next(e);
+    if(timer_expired(&e->lifetimer)) {
+      PRINTF("uip_packetqueue entry timed out %p\n", e->handle);
+      entry_remove(e);
+      stats.timedout++;
+    }
+  }
+  queue_timer_set();
+}
+/*---------------------------------------------------------------------------*/
 void
 uip_packetqueue_new(struct uip_packetqueue_handle *handle)
 {
   PRINTF("uip_packetqueue_new %p\n", handle);
   handle->packet = NULL;
+  handle->queue = NULL;
+  handle->queue_len = 0;
 }
 /*---------------------------------------------------------------------------*/
 struct uip_packetqueue_packet *
@@ -49,8 +123,10 @@ uip_packetqueue_alloc(struct uip_packetqueue_handle *handle, clock_time_t lifeti
   }
   handle->packet = memb_alloc(&packets_memb);
   if(handle->packet != NULL) {
-    ctimer_set(&handle->packet->lifetimer, lifetime,
-               packet_timedout, handle);
+    if(lifetime > 0) {
+      ctimer_set(&handle->packet->lifetimer, lifetime,
+                 packet_timedout, handle);
+    }
   } else {
     PRINTF("uip_packetqueue_alloc failed\n");
   }
@@ -66,6 +142,12 @@ uip_packetqueue_free(struct uip_packetqueue_handle *handle)
     memb_free(&packets_memb, handle->packet);
     handle->packet = NULL;
   }
+  if(handle->queue != NULL) {
+    while(handle->queue != NULL) {
+      entry_remove(handle->queue);
+    }
+    queue_timer_set();
+  }
 }
 /*---------------------------------------------------------------------------*/
 uint8_t *
@@ -88,3 +170,85 @@ uip_packetqueue_set_buflen(struct uip_packetqueue_handle *h, uint16_t len)
   }
 }
 /*---------------------------------------------------------------------------*/
+int
+uip_packetqueue_numfree(void)
+{
+  return memb_numfree(&packets_memb);
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_packetqueue_enqueue(struct uip_packetqueue_handle *h,
+                        clock_time_t lifetime)
+{
+  struct uip_packetqueue_entry *e;
+  struct uip_packetqueue_entry **pp;
+
+  if(uip_len == 0 || uip_len > UIP_PACKETQUEUE_BYTES) {
+    stats.dropped++;
+    return 0;
+  }
+
+  /* A handle keeps its newest packets */
+  if(h->queue_len >= UIP_PACKETQUEUE_NBR_MAX) {
+    PRINTF("uip_packetqueue_enqueue %p full\n", h);
+    entry_remove(h->queue);
+    stats.evicted++;
+  }
+
+  /* Make room by dropping the least recently queued packets */
+  while(queued_bytes + uip_len > UIP_PACKETQUEUE_BYTES ||
+        memb_numfree(&entries_memb) == 0) {
+    PRINTF("uip_packetqueue_enqueue evicts %p\n",
+           ((struct uip_packetqueue_entry *)dlist_head(entries_list))->handle);
+    entry_remove(dlist_head(entries_list));
+    stats.evicted++;
+  }
+
+  e = memb_alloc(&entries_memb);
+  if(e == NULL || !mmem_alloc(&e->mem, uip_len)) {
+    if(e != NULL) {
+      memb_free(&entries_memb, e);
+    }
+    stats.dropped++;
+    return 0;
+  }
+  memcpy(MMEM_PTR(&e->mem), UIP_IP_BUF, uip_len);
+  queued_bytes += uip_len;
+
+  e->handle = h;
+  e->qnext = NULL;
+  for(pp = &h->queue; *pp != NULL; pp = &(*pp)->qnext);
+  *pp = e;
+  h->queue_len++;
+  dlist_add(entries_list, e);
+
+  timer_set(&e->lifetimer, lifetime);
+  queue_timer_set();
+  stats.queued++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_packetqueue_dequeue(struct uip_packetqueue_handle *h)
+{
+  struct uip_packetqueue_entry *e = h->queue;
+
+  if(e == NULL) {
+    return 0;
+  }
+
+  uip_len = e->mem.size;
+  memcpy(UIP_IP_BUF, MMEM_PTR(&e->mem), uip_len);
+  entry_remove(e);
+  stats.dequeued++;
+  return uip_len;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_packetqueue_get_stats(struct uip_packetqueue_stats *s)
+{
+  if(s != NULL) {
+    *s = stats;
+  }
+}
+/*---------------------------------------------------------------------------*/
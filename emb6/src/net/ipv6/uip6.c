@@ -78,6 +78,7 @@
 #include "emb6_conf.h"
 #include "emb6.h"
 #include "uip.h"
+#include "uip_arch.h"
 #include "uipopt.h"
 #include "uip-icmp6.h"
 #include "uip-nd6.h"
@@ -325,8 +326,11 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #endif /* UIP_ARCH_ADD32 && UIP_TCP */
 
-#if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
+#if UIP_ARCH_CHKSUM
+/* The target sums the buffer, see uip_arch_chksum() in uip_arch.h */
+#define chksum(sum, data, len)  uip_arch_chksum(sum, data, len)
+#else /* UIP_ARCH_CHKSUM */
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
@@ -357,6 +361,7 @@ chksum(uint16_t sum, const uint8_t *data, uint16_t len)
   /* Return sum in host byte order. */
   return sum;
 }
+#endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
@@ -431,7 +436,32 @@ uip_udpchksum(void)
   return upper_layer_chksum(UIP_PROTO_UDP);
 }
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
-#endif /* UIP_ARCH_CHKSUM */
+/*---------------------------------------------------------------------------*/
+static uint16_t
+chksum_adjust(uint16_t field, uint16_t sum)
+{
+  uint16_t t;
+
+  /* HC' = ~(~HC + ~m + m'), RFC1624 eqn. 3 */
+  t = ~uip_ntohs(field);
+  sum += t;
+  if(sum < t) {
+    sum++;      /* carry */
+  }
+  return uip_htons(~sum);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_remove(uint16_t field, const uint8_t *data, uint16_t len)
+{
+  return chksum_adjust(field, ~chksum(0, data, len));
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_add(uint16_t field, const uint8_t *data, uint16_t len)
+{
+  return chksum_adjust(field, chksum(0, data, len));
+}
 /*---------------------------------------------------------------------------*/
 void
 uip_init(void)
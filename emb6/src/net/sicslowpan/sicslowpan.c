@@ -82,6 +82,9 @@
 #include "framer-802154.h"
 
 #include "uip-ds6-nbr.h"
+#if UIP_CONF_IPV6_RPL
+#include "rpl.h"
+#endif /* UIP_CONF_IPV6_RPL */
 
 
 
@@ -168,6 +171,7 @@ void uip_log(char *msg);
 #define UIP_UDP_BUF          ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN])
 #define UIP_TCP_BUF          ((struct uip_tcp_hdr *)&uip_buf[UIP_LLIPH_LEN])
 #define UIP_ICMP_BUF          ((struct uip_icmp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+#define UIP_EXT_BUF          ((struct uip_ext_hdr *)&uip_buf[UIP_LLIPH_LEN])
 /** @} */
 
 
@@ -182,6 +186,14 @@ void uip_log(char *msg);
 /** \brief Some MAC layers need a minimum payload, which is
     configurable through the SICSLOWPAN_CONF_MIN_MAC_PAYLOAD
     option. */
+/** \brief Relay fragments of routed datagrams instead of reassembling
+    them, see SICSLOWPAN_CONF_FRAG_FORWARD. */
+#if SICSLOWPAN_CONF_FRAG && UIP_CONF_ROUTER && SICSLOWPAN_FRAG_FORWARD
+#define SICSLOWPAN_VRB 1
+#else
+#define SICSLOWPAN_VRB 0
+#endif
+
 #ifdef SICSLOWPAN_CONF_COMPRESSION_THRESHOLD
 #define COMPRESSION_THRESHOLD SICSLOWPAN_CONF_COMPRESSION_THRESHOLD
 #else
@@ -235,35 +247,70 @@ static int last_tx_status;
  *  @{
  */
 
-static uint16_t sicslowpan_len;
-
 /**
- * The buffer used for the 6lowpan reassembly.
- * This buffer contains only the IPv6 packet (no MAC header, 6lowpan, etc).
+ * A 6lowpan reassembly context.
+ * The buffer contains only the IPv6 packet (no MAC header, 6lowpan, etc).
  * It has a fix size as we do not use dynamic memory allocation.
  */
-static uip_buf_t sicslowpan_aligned_buf;
-#define sicslowpan_buf (sicslowpan_aligned_buf.u8)
+struct sicslowpan_reass {
+  uip_buf_t buf;
+  /** Reassembly timeout */
+  struct timer timer;
+  /** Source address of the fragments being merged */
+  linkaddr_t sender;
+  /** Tag of the fragments being merged */
+  uint16_t tag;
+  /** Size of the IPv6 packet, 0 if the context is free */
+  uint16_t size;
+  /** Number of 8 byte blocks received so far */
+  uint16_t received;
+  /** Bitmap of the 8 byte blocks received so far */
+  uint8_t blocks[(UIP_BUFSIZE / 8 + 8) / 8];
+};
+
+/** The reassembly contexts, one per datagram being merged */
+static struct sicslowpan_reass reass_ctx[SICSLOWPAN_REASS_CONTEXTS];
 
-/** The total length of the IPv6 packet in the sicslowpan_buf. */
+/** Reassembly counters */
+static struct sicslowpan_reass_stats reass_stats;
 
 /**
- * length of the ip packet already sent / received.
- * It includes IP and transport headers.
+ * The buffer the incoming packet is uncompressed into, either uip_buf
+ * or the buffer of a reassembly context.
  */
-static uint16_t processed_ip_in_len;
+static uint8_t *sicslowpan_buf;
 
 /** Datagram tag to be put in the fragments I send. */
 static uint16_t my_tag;
 
-/** When reassembling, the tag in the fragments being merged. */
-static uint16_t reass_tag;
-
-/** When reassembling, the source address of the fragments being merged */
-linkaddr_t frag_sender;
+#if SICSLOWPAN_VRB
+/**
+ * A virtual reassembly buffer entry. The fragments of a datagram routed
+ * through this node are relayed to the next hop as they arrive, only
+ * the first fragment is uncompressed to take the routing decision.
+ */
+struct sicslowpan_vrb {
+  /** Lifetime of the entry */
+  struct timer timer;
+  /** Source address of the incoming fragments */
+  linkaddr_t sender;
+  /** Tag of the incoming fragments */
+  uint16_t tag;
+  /** Size of the IPv6 packet, 0 if the entry is free */
+  uint16_t size;
+  /** Number of 8 byte blocks relayed so far */
+  uint16_t received;
+  /** Bitmap of the 8 byte blocks relayed so far */
+  uint8_t blocks[(UIP_BUFSIZE / 8 + 8) / 8];
+  /** Link layer address of the next hop */
+  linkaddr_t nexthop;
+  /** Tag of the outgoing fragments */
+  uint16_t out_tag;
+};
 
-/** Reassembly %process %timer. */
-static struct timer reass_timer;
+/** The virtual reassembly buffers */
+static struct sicslowpan_vrb vrb_table[SICSLOWPAN_VRB_ENTRIES];
+#endif /* SICSLOWPAN_VRB */
 
 /** @} */
 #else /* SICSLOWPAN_CONF_FRAG */
@@ -343,6 +390,33 @@ static struct sicslowpan_addr_context *context;
 /** pointer to the byte where to write next inline field. */
 static uint8_t *hc06_ptr;
 
+/**
+ * Compressed addresses of a flow. The address part of the IPHC
+ * encoding only depends on the source, destination and link
+ * destination address, so it is reused by the packets of a flow.
+ */
+struct sicslowpan_hc06_flow {
+  uip_ipaddr_t srcipaddr;
+  uip_ipaddr_t destipaddr;
+  linkaddr_t link_destaddr;
+  uint8_t used;
+  /** Address bits of the second IPHC byte */
+  uint8_t iphc1;
+  /** SCI | DCI byte, if SICSLOWPAN_IPHC_CID is set */
+  uint8_t cid;
+  /** Number of inline address bytes */
+  uint8_t len;
+  uint8_t addr[2 * sizeof(uip_ipaddr_t)];
+};
+
+#if SICSLOWPAN_HC06_FLOWS > 0
+static struct sicslowpan_hc06_flow hc06_flows[SICSLOWPAN_HC06_FLOWS];
+/** Flow which is replaced next */
+static uint8_t hc06_flow_next;
+#else
+static struct sicslowpan_hc06_flow hc06_flows[1];
+#endif /* SICSLOWPAN_HC06_FLOWS > 0 */
+
 /* Uncompression of linklocal */
 /*   0 -> 16 bytes from packet  */
 /*   1 -> 2 bytes from prefix - bunch of zeroes and 8 from packet */
@@ -471,6 +545,161 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
   PRINTF("\n\r");
 }
 
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compress the addresses of the IPv6 header in uip_buf
+ *
+ * Fills the address bits of the second IPHC byte, the context
+ * identifier byte and the inline address fields of a flow.
+ * \param flow The flow which is filled
+ * \param link_destaddr L2 destination address, needed to compress IP
+ * dest
+ */
+static void
+compress_addrs_hc06(struct sicslowpan_hc06_flow *flow,
+                    linkaddr_t *link_destaddr)
+{
+  uint8_t iphc1 = 0;
+  uint8_t cid = 0;
+  uint8_t *inline_ptr = hc06_ptr;
+
+  hc06_ptr = flow->addr;
+
+  /* check if dest context exists (for allocating third byte) */
+  if(addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr) != NULL ||
+     addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr) != NULL) {
+    /* set context flag */
+    PRINTF("IPHC: compressing dest or src ipaddr - setting CID\n\r");
+    iphc1 |= SICSLOWPAN_IPHC_CID;
+  }
+
+  /* source address - cannot be multicast */
+  if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
+    PRINTF("IPHC: compressing unspecified - setting SAC\n\r");
+    iphc1 |= SICSLOWPAN_IPHC_SAC;
+    iphc1 |= SICSLOWPAN_IPHC_SAM_00;
+  } else if((context = addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr))
+     != NULL) {
+    /* elide the prefix - indicate by CID and set context + SAC */
+    PRINTF("IPHC: compressing src with context - setting CID & SAC ctx: %d\n\r",
+       context->number);
+    iphc1 |= SICSLOWPAN_IPHC_CID | SICSLOWPAN_IPHC_SAC;
+    cid |= context->number << 4;
+    /* compession compare with this nodes address (source) */
+
+    iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
+                              &UIP_IP_BUF->srcipaddr, &uip_lladdr);
+    /* No context found for this address */
+  } else if(uip_is_addr_link_local(&UIP_IP_BUF->srcipaddr) &&
+        UIP_IP_BUF->destipaddr.u16[1] == 0 &&
+        UIP_IP_BUF->destipaddr.u16[2] == 0 &&
+        UIP_IP_BUF->destipaddr.u16[3] == 0) {
+    iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
+                              &UIP_IP_BUF->srcipaddr, &uip_lladdr);
+  } else {
+    /* send the full address => SAC = 0, SAM = 00 */
+    iphc1 |= SICSLOWPAN_IPHC_SAM_00; /* 128-bits */
+    memcpy(hc06_ptr, &UIP_IP_BUF->srcipaddr.u16[0], 16);
+    hc06_ptr += 16;
+  }
+
+  /* dest address*/
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
+    /* Address is multicast, try to compress */
+    iphc1 |= SICSLOWPAN_IPHC_M;
+    if(sicslowpan_is_mcast_addr_compressable8(&UIP_IP_BUF->destipaddr)) {
+      iphc1 |= SICSLOWPAN_IPHC_DAM_11;
+      /* use last byte */
+      *hc06_ptr = UIP_IP_BUF->destipaddr.u8[15];
+      hc06_ptr += 1;
+    } else if(sicslowpan_is_mcast_addr_compressable32(&UIP_IP_BUF->destipaddr)) {
+      iphc1 |= SICSLOWPAN_IPHC_DAM_10;
+      /* second byte + the last three */
+      *hc06_ptr = UIP_IP_BUF->destipaddr.u8[1];
+      memcpy(hc06_ptr + 1, &UIP_IP_BUF->destipaddr.u8[13], 3);
+      hc06_ptr += 4;
+    } else if(sicslowpan_is_mcast_addr_compressable48(&UIP_IP_BUF->destipaddr)) {
+      iphc1 |= SICSLOWPAN_IPHC_DAM_01;
+      /* second byte + the last five */
+      *hc06_ptr = UIP_IP_BUF->destipaddr.u8[1];
+      memcpy(hc06_ptr + 1, &UIP_IP_BUF->destipaddr.u8[11], 5);
+      hc06_ptr += 6;
+    } else {
+      iphc1 |= SICSLOWPAN_IPHC_DAM_00;
+      /* full address */
+      memcpy(hc06_ptr, &UIP_IP_BUF->destipaddr.u8[0], 16);
+      hc06_ptr += 16;
+    }
+  } else {
+    /* Address is unicast, try to compress */
+    if((context = addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr)) != NULL) {
+      /* elide the prefix */
+      iphc1 |= SICSLOWPAN_IPHC_DAC;
+      cid |= context->number;
+      /* compession compare with link adress (destination) */
+
+      iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
+           &UIP_IP_BUF->destipaddr, (uip_lladdr_t *)link_destaddr);
+      /* No context found for this address */
+    } else if(uip_is_addr_link_local(&UIP_IP_BUF->destipaddr) &&
+          UIP_IP_BUF->destipaddr.u16[1] == 0 &&
+          UIP_IP_BUF->destipaddr.u16[2] == 0 &&
+          UIP_IP_BUF->destipaddr.u16[3] == 0) {
+      iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
+               &UIP_IP_BUF->destipaddr, (uip_lladdr_t *)link_destaddr);
+    } else {
+      /* send the full address */
+      iphc1 |= SICSLOWPAN_IPHC_DAM_00; /* 128-bits */
+      memcpy(hc06_ptr, &UIP_IP_BUF->destipaddr.u16[0], 16);
+      hc06_ptr += 16;
+    }
+  }
+
+  flow->iphc1 = iphc1;
+  flow->cid = cid;
+  flow->len = hc06_ptr - flow->addr;
+  hc06_ptr = inline_ptr;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the flow of the packet in uip_buf
+ *
+ * Packets of a flow only differ in fields which are cheap to
+ * compress, so the compressed addresses of the flow are reused. If
+ * the flow is not known, it replaces the oldest one.
+ * \param link_destaddr L2 destination address of the packet
+ * \return The flow with the compressed addresses of the packet
+ */
+static struct sicslowpan_hc06_flow *
+hc06_flow_lookup(linkaddr_t *link_destaddr)
+{
+  struct sicslowpan_hc06_flow *flow;
+#if SICSLOWPAN_HC06_FLOWS > 0
+  uint8_t i;
+
+  for(i = 0; i < SICSLOWPAN_HC06_FLOWS; i++) {
+    flow = &hc06_flows[i];
+    if(flow->used &&
+       uip_ipaddr_cmp(&flow->destipaddr, &UIP_IP_BUF->destipaddr) &&
+       uip_ipaddr_cmp(&flow->srcipaddr, &UIP_IP_BUF->srcipaddr) &&
+       linkaddr_cmp(&flow->link_destaddr, link_destaddr)) {
+      return flow;
+    }
+  }
+
+  flow = &hc06_flows[hc06_flow_next];
+  hc06_flow_next = (hc06_flow_next + 1) % SICSLOWPAN_HC06_FLOWS;
+  uip_ipaddr_copy(&flow->srcipaddr, &UIP_IP_BUF->srcipaddr);
+  uip_ipaddr_copy(&flow->destipaddr, &UIP_IP_BUF->destipaddr);
+  linkaddr_copy(&flow->link_destaddr, link_destaddr);
+  flow->used = 1;
+#else
+  flow = &hc06_flows[0];
+#endif /* SICSLOWPAN_HC06_FLOWS > 0 */
+  compress_addrs_hc06(flow, link_destaddr);
+  return flow;
+}
+
 /*--------------------------------------------------------------------*/
 /**
  * \brief Compress IP/UDP header
@@ -510,6 +739,7 @@ static void
 compress_hdr_hc06(linkaddr_t *link_destaddr)
 {
   uint8_t tmp, iphc0, iphc1;
+  struct sicslowpan_hc06_flow *flow;
 #if DEBUG
   { uint16_t ndx;
     PRINTF("before compression (%d): ", UIP_IP_BUF->len[1]);
@@ -530,24 +760,16 @@ compress_hdr_hc06(linkaddr_t *link_destaddr)
    */
 
   iphc0 = SICSLOWPAN_DISPATCH_IPHC;
-  iphc1 = 0;
-  PACKETBUF_IPHC_BUF[2] = 0; /* might not be used - but needs to be cleared */
 
   /*
    * Address handling needs to be made first since it might
-   * cause an extra byte with [ SCI | DCI ]
-   *
+   * cause an extra byte with [ SCI | DCI ]. The addresses are
+   * compressed once per flow.
    */
-
-
-  /* check if dest context exists (for allocating third byte) */
-  /* TODO: fix this so that it remembers the looked up values for
-     avoiding two lookups - or set the lookup values immediately */
-  if(addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr) != NULL ||
-     addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr) != NULL) {
-    /* set context flag and increase hc06_ptr */
-    PRINTF("IPHC: compressing dest or src ipaddr - setting CID\n\r");
-    iphc1 |= SICSLOWPAN_IPHC_CID;
+  flow = hc06_flow_lookup(link_destaddr);
+  iphc1 = flow->iphc1;
+  if(iphc1 & SICSLOWPAN_IPHC_CID) {
+    PACKETBUF_IPHC_BUF[2] = flow->cid;
     hc06_ptr++;
   }
 
@@ -635,87 +857,9 @@ compress_hdr_hc06(linkaddr_t *link_destaddr)
       break;
   }
 
-  /* source address - cannot be multicast */
-  if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
-    PRINTF("IPHC: compressing unspecified - setting SAC\n\r");
-    iphc1 |= SICSLOWPAN_IPHC_SAC;
-    iphc1 |= SICSLOWPAN_IPHC_SAM_00;
-  } else if((context = addr_context_lookup_by_prefix(&UIP_IP_BUF->srcipaddr))
-     != NULL) {
-    /* elide the prefix - indicate by CID and set context + SAC */
-    PRINTF("IPHC: compressing src with context - setting CID & SAC ctx: %d\n\r",
-       context->number);
-    iphc1 |= SICSLOWPAN_IPHC_CID | SICSLOWPAN_IPHC_SAC;
-    PACKETBUF_IPHC_BUF[2] |= context->number << 4;
-    /* compession compare with this nodes address (source) */
-
-    iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
-                              &UIP_IP_BUF->srcipaddr, &uip_lladdr);
-    /* No context found for this address */
-  } else if(uip_is_addr_link_local(&UIP_IP_BUF->srcipaddr) &&
-        UIP_IP_BUF->destipaddr.u16[1] == 0 &&
-        UIP_IP_BUF->destipaddr.u16[2] == 0 &&
-        UIP_IP_BUF->destipaddr.u16[3] == 0) {
-    iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
-                              &UIP_IP_BUF->srcipaddr, &uip_lladdr);
-  } else {
-    /* send the full address => SAC = 0, SAM = 00 */
-    iphc1 |= SICSLOWPAN_IPHC_SAM_00; /* 128-bits */
-    memcpy(hc06_ptr, &UIP_IP_BUF->srcipaddr.u16[0], 16);
-    hc06_ptr += 16;
-  }
-
-  /* dest address*/
-  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
-    /* Address is multicast, try to compress */
-    iphc1 |= SICSLOWPAN_IPHC_M;
-    if(sicslowpan_is_mcast_addr_compressable8(&UIP_IP_BUF->destipaddr)) {
-      iphc1 |= SICSLOWPAN_IPHC_DAM_11;
-      /* use last byte */
-      *hc06_ptr = UIP_IP_BUF->destipaddr.u8[15];
-      hc06_ptr += 1;
-    } else if(sicslowpan_is_mcast_addr_compressable32(&UIP_IP_BUF->destipaddr)) {
-      iphc1 |= SICSLOWPAN_IPHC_DAM_10;
-      /* second byte + the last three */
-      *hc06_ptr = UIP_IP_BUF->destipaddr.u8[1];
-      memcpy(hc06_ptr + 1, &UIP_IP_BUF->destipaddr.u8[13], 3);
-      hc06_ptr += 4;
-    } else if(sicslowpan_is_mcast_addr_compressable48(&UIP_IP_BUF->destipaddr)) {
-      iphc1 |= SICSLOWPAN_IPHC_DAM_01;
-      /* second byte + the last five */
-      *hc06_ptr = UIP_IP_BUF->destipaddr.u8[1];
-      memcpy(hc06_ptr + 1, &UIP_IP_BUF->destipaddr.u8[11], 5);
-      hc06_ptr += 6;
-    } else {
-      iphc1 |= SICSLOWPAN_IPHC_DAM_00;
-      /* full address */
-      memcpy(hc06_ptr, &UIP_IP_BUF->destipaddr.u8[0], 16);
-      hc06_ptr += 16;
-    }
-  } else {
-    /* Address is unicast, try to compress */
-    if((context = addr_context_lookup_by_prefix(&UIP_IP_BUF->destipaddr)) != NULL) {
-      /* elide the prefix */
-      iphc1 |= SICSLOWPAN_IPHC_DAC;
-      PACKETBUF_IPHC_BUF[2] |= context->number;
-      /* compession compare with link adress (destination) */
-
-      iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
-           &UIP_IP_BUF->destipaddr, (uip_lladdr_t *)link_destaddr);
-      /* No context found for this address */
-    } else if(uip_is_addr_link_local(&UIP_IP_BUF->destipaddr) &&
-          UIP_IP_BUF->destipaddr.u16[1] == 0 &&
-          UIP_IP_BUF->destipaddr.u16[2] == 0 &&
-          UIP_IP_BUF->destipaddr.u16[3] == 0) {
-      iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
-               &UIP_IP_BUF->destipaddr, (uip_lladdr_t *)link_destaddr);
-    } else {
-      /* send the full address */
-      iphc1 |= SICSLOWPAN_IPHC_DAM_00; /* 128-bits */
-      memcpy(hc06_ptr, &UIP_IP_BUF->destipaddr.u16[0], 16);
-      hc06_ptr += 16;
-    }
-  }
+  /* source and dest address */
+  memcpy(hc06_ptr, flow->addr, flow->len);
+  hc06_ptr += flow->len;
 
   uncomp_hdr_len = UIP_IPH_LEN;
 
@@ -1370,6 +1514,91 @@ send_packet(linkaddr_t *dest)
 
 }
 /*--------------------------------------------------------------------*/
+/**
+ * \brief Get the room left for 6lowpan in a frame sent to \p dest
+ *
+ * Calculate NETSTACK_FRAMER's header length, that will be added in the
+ * NETSTACK_RDC. We calculate it here only to make a better decision of
+ * whether the outgoing packet needs to be fragmented or not.
+ *
+ * \return The maximum 6lowpan frame size or -1 if there is no framer
+ */
+static int
+mac_max_payload(linkaddr_t *dest)
+{
+  int framer_hdrlen;
+
+#define USE_FRAMER_HDRLEN 1
+#if USE_FRAMER_HDRLEN
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  if ((p_ns == NULL) || (p_ns->frame == NULL))
+      return -1;
+
+  framer_hdrlen = p_ns->frame->length();
+  if(framer_hdrlen < 0) {
+    /* Framing failed, we assume the maximum header length */
+    framer_hdrlen = 21;
+  }
+#else /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = 21;
+#endif /* USE_FRAMER_HDRLEN */
+  return MAC_MAX_PAYLOAD - framer_hdrlen - p_ns->llsec->get_overhead();
+}
+#if SICSLOWPAN_VRB
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Send a part of a datagram in FRAGN fragments
+ * \param dest The MAC address of the next hop
+ * \param size The size of the datagram
+ * \param tag The datagram tag of the fragments
+ * \param offset Offset of the data in the datagram, multiple of 8
+ * \param data The data to send
+ * \param len Length of the data, split into several fragments if
+ *            it does not fit into one frame
+ * \return 1 if all fragments were sent, 0 otherwise
+ */
+static int
+send_fragn(linkaddr_t *dest, uint16_t size, uint16_t tag, uint16_t offset,
+           const uint8_t *data, uint16_t len)
+{
+  int max_payload;
+  uint16_t n;
+
+  while(len > 0) {
+    packetbuf_clear();
+    packetbuf_ptr = packetbuf_dataptr();
+    packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                       SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+    max_payload = mac_max_payload(dest) - SICSLOWPAN_FRAGN_HDR_LEN;
+    if(max_payload < 8) {
+      return 0;
+    }
+    n = len > max_payload ? max_payload & 0xfff8 : len;
+
+    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | size));
+    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, tag);
+    PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = offset >> 3;
+    PRINTFO("sicslowpan output: relay fragment (offset %d, len %d, tag %d)\n\r",
+            offset >> 3, n, tag);
+    memcpy(packetbuf_ptr + SICSLOWPAN_FRAGN_HDR_LEN, data, n);
+    packetbuf_set_datalen(SICSLOWPAN_FRAGN_HDR_LEN + n);
+    send_packet(dest);
+
+    if((last_tx_status == MAC_TX_COLLISION) ||
+       (last_tx_status == MAC_TX_ERR) ||
+       (last_tx_status == MAC_TX_ERR_FATAL)) {
+      PRINTFO("error in fragment tx, dropping subsequent fragments.\n\r");
+      return 0;
+    }
+    offset += n;
+    data += n;
+    len -= n;
+  }
+  return 1;
+}
+#endif /* SICSLOWPAN_VRB */
+/*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
  *  \param localdest The MAC address of the destination
@@ -1381,7 +1610,6 @@ send_packet(linkaddr_t *dest)
  */
 static uint8_t output(const uip_lladdr_t *localdest)
 {
-  int framer_hdrlen;
   int max_payload;
 
   /* The MAC address of the destination of the packet */
@@ -1451,24 +1679,10 @@ static uint8_t output(const uip_lladdr_t *localdest)
   }
   PRINTFO("sicslowpan output: header of len %d\n\r", packetbuf_hdr_len);
 
-  /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
-   * We calculate it here only to make a better decision of whether the outgoing packet
-   * needs to be fragmented or not. */
-#define USE_FRAMER_HDRLEN 1
-#if USE_FRAMER_HDRLEN
-  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
-  if ((p_ns == NULL) || (p_ns->frame == NULL))
-      return 0;
-
-  framer_hdrlen = p_ns->frame->length();
-  if(framer_hdrlen < 0) {
-    /* Framing failed, we assume the maximum header length */
-    framer_hdrlen = 21;
+  max_payload = mac_max_payload(&dest);
+  if(max_payload < 0) {
+    return 0;
   }
-#else /* USE_FRAMER_HDRLEN */
-  framer_hdrlen = 21;
-#endif /* USE_FRAMER_HDRLEN */
-  max_payload = MAC_MAX_PAYLOAD - framer_hdrlen - p_ns->llsec->get_overhead();
 
   if((int)uip_len - (int)uncomp_hdr_len > max_payload - (int)packetbuf_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
@@ -1598,6 +1812,330 @@ static uint8_t output(const uip_lladdr_t *localdest)
   return 1;
 }
 
+#if SICSLOWPAN_CONF_FRAG
+/*--------------------------------------------------------------------*/
+/** \brief Release reassembly contexts whose timer has expired */
+static void
+reass_expire(void)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(reass_ctx[i].size != 0 && timer_expired(&reass_ctx[i].timer)) {
+      PRINTFI("sicslowpan input: reassembly timed out (tag %d)\n\r",
+              reass_ctx[i].tag);
+      reass_ctx[i].size = 0;
+      reass_stats.timedout++;
+    }
+  }
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the reassembly context of a fragment and allocate one if
+ * this is the first fragment of the datagram we see.
+ *
+ * The context is keyed by sender, tag and datagram size. If all contexts
+ * are busy and \p evict is set, the oldest datagram is discarded in favour
+ * of the new one. This lessens the negative impacts of too high
+ * SICSLOWPAN_REASS_MAXAGE.
+ *
+ * \return The context or NULL if none is available
+ */
+static struct sicslowpan_reass *
+reass_lookup(uint16_t frag_size, uint16_t frag_tag, int evict)
+{
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  struct sicslowpan_reass *ctx = NULL;
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(reass_ctx[i].size == frag_size && reass_ctx[i].tag == frag_tag &&
+       linkaddr_cmp(&reass_ctx[i].sender, sender)) {
+      return &reass_ctx[i];
+    }
+    /* Prefer a free context, then the oldest datagram */
+    if(ctx == NULL || (ctx->size != 0 &&
+       (reass_ctx[i].size == 0 ||
+        timer_remaining(&reass_ctx[i].timer) < timer_remaining(&ctx->timer)))) {
+      ctx = &reass_ctx[i];
+    }
+  }
+
+  if(ctx->size != 0) {
+    if(!evict) {
+      return NULL;
+    }
+    PRINTFI("sicslowpan input: discarding datagram (tag %d) in favour of a new one\n\r",
+            ctx->tag);
+    reass_stats.evicted++;
+  }
+  PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n\r",
+          frag_size, frag_tag);
+  ctx->size = frag_size;
+  ctx->tag = frag_tag;
+  ctx->received = 0;
+  memset(ctx->blocks, 0, sizeof(ctx->blocks));
+  linkaddr_copy(&ctx->sender, sender);
+  timer_set(&ctx->timer, SICSLOWPAN_REASS_MAXAGE * bsp_get(E_BSP_GET_TRES));
+  return ctx;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Mark the 8 byte blocks covered by a fragment in a block bitmap
+ * \param blocks The bitmap of a datagram of \p size bytes
+ * \param received Number of blocks set in \p blocks, updated
+ * \return 0 if the fragment was seen before, 1 otherwise
+ */
+static int
+frag_mark(uint8_t *blocks, uint16_t *received, uint16_t size,
+          uint16_t offset, uint16_t end)
+{
+  uint16_t block = offset >> 3;
+  uint16_t last;
+
+  /* Only the last fragment may end in the middle of a block */
+  last = end == size ? (end + 7) >> 3 : end >> 3;
+  if(block >= last || (blocks[block >> 3] & (1 << (block & 7))) != 0) {
+    return 0;
+  }
+  for(; block < last; block++) {
+    if((blocks[block >> 3] & (1 << (block & 7))) == 0) {
+      blocks[block >> 3] |= 1 << (block & 7);
+      (*received)++;
+    }
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Mark the 8 byte blocks covered by a fragment as received
+ * \return 0 if the fragment was received before, 1 otherwise
+ */
+static int
+reass_mark(struct sicslowpan_reass *ctx, uint16_t offset, uint16_t end)
+{
+  return frag_mark(ctx->blocks, &ctx->received, ctx->size, offset, end);
+}
+#if SICSLOWPAN_VRB
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the virtual reassembly buffer of a datagram
+ * \return The entry or NULL if the fragments of the datagram are not
+ * relayed
+ */
+static struct sicslowpan_vrb *
+vrb_lookup(uint16_t frag_size, uint16_t frag_tag)
+{
+  const linkaddr_t *sender = packetbuf_addr(PACKETBUF_ADDR_SENDER);
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb_table[i].size != 0 && timer_expired(&vrb_table[i].timer)) {
+      vrb_table[i].size = 0;
+    }
+    if(vrb_table[i].size == frag_size && vrb_table[i].tag == frag_tag &&
+       linkaddr_cmp(&vrb_table[i].sender, sender)) {
+      return &vrb_table[i];
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Relay a datagram whose first fragment is in \p ctx
+ *
+ * The forwarding steps of uip_process() and tcpip_ipv6_output() are
+ * applied to the first fragment only: the RPL option is checked and
+ * updated, the hop limit decremented and the next hop looked up. The
+ * first fragment is compressed again for the next hop and sent with a
+ * new tag, together with the fragments that arrived before it. A
+ * virtual reassembly buffer then relays the remaining fragments.
+ *
+ * Whenever the datagram needs more than that (a neighbor to resolve,
+ * an RPL option to insert, an ICMP error to send, ...), the datagram is
+ * reassembled and handed to the IP layer as usual.
+ *
+ * \param ctx The reassembly context holding the first fragment, it is
+ *            released unless the datagram has to be reassembled
+ * \param frag1_end End of the first fragment in the datagram
+ */
+static void
+vrb_forward(struct sicslowpan_reass *ctx, uint16_t frag1_end)
+{
+  struct uip_ip_hdr *hdr = (struct uip_ip_hdr *)&ctx->buf.u8[UIP_LLH_LEN];
+  struct sicslowpan_vrb *vrb = NULL;
+  uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+  linkaddr_t dest;
+  int max_payload;
+  uint16_t block;
+  uint16_t start;
+  uint16_t end;
+  int i;
+
+  /* Only datagrams uip_process() would forward */
+  if(frag1_end < UIP_IPH_LEN || (frag1_end & 7) != 0 ||
+     uip_ds6_is_my_addr(&hdr->destipaddr) ||
+     uip_ds6_is_my_maddr(&hdr->destipaddr) ||
+     uip_is_addr_mcast(&hdr->destipaddr) ||
+     uip_is_addr_link_local(&hdr->destipaddr) ||
+     uip_is_addr_loopback(&hdr->destipaddr) ||
+     uip_is_addr_link_local(&hdr->srcipaddr) ||
+     uip_is_addr_unspecified(&hdr->srcipaddr) ||
+     hdr->ttl <= 1) {
+    return;
+  }
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb_table[i].size != 0 && timer_expired(&vrb_table[i].timer)) {
+      vrb_table[i].size = 0;
+    }
+    if(vrb_table[i].size == 0) {
+      vrb = &vrb_table[i];
+      break;
+    }
+  }
+  if(vrb == NULL) {
+    return;
+  }
+
+  /* Work on a copy of the first fragment, so that the datagram can
+   * still be reassembled if it cannot be relayed */
+  memcpy(UIP_IP_BUF, hdr, frag1_end);
+  uip_len = frag1_end;
+  uip_ext_len = 0;
+
+#if UIP_CONF_IPV6_RPL
+  /* The RPL option must be there already, inserting it would shift the
+   * offsets of the following fragments */
+  if(UIP_IP_BUF->proto != UIP_PROTO_HBHO ||
+     UIP_IPH_LEN + 8 * (UIP_EXT_BUF->len + 1) > frag1_end ||
+     uip_buf[UIP_LLIPH_LEN + 2] != UIP_EXT_HDR_OPT_RPL) {
+    return;
+  }
+  if(rpl_verify_header(2) || rpl_update_header_empty()) {
+    PRINTFI("sicslowpan input: RPL option error, dropping datagram\n\r");
+    goto drop;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+  UIP_IP_BUF->ttl = UIP_IP_BUF->ttl - 1;
+
+  /* Next hop determination, see tcpip_ipv6_output() */
+  if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  } else if((route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr)) != NULL) {
+    nexthop = uip_ds6_route_nexthop(route);
+  } else {
+    nexthop = uip_ds6_defrt_choose();
+  }
+  if(nexthop == NULL) {
+    return;
+  }
+#if UIP_CONF_IPV6_RPL
+  if(rpl_update_header_final(nexthop)) {
+    goto drop;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+  nbr = uip_ds6_nbr_lookup(nexthop);
+  if(nbr == NULL || nbr->state == NBR_INCOMPLETE) {
+    return;
+  }
+  linkaddr_copy(&dest, (const linkaddr_t *)uip_ds6_nbr_get_ll(nbr));
+
+  /* Compress the header for the next hop */
+  uncomp_hdr_len = 0;
+  packetbuf_hdr_len = 0;
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC1
+  compress_hdr_hc1(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC1 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
+  compress_hdr_ipv6(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_hc06(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+  max_payload = mac_max_payload(&dest) - packetbuf_hdr_len - SICSLOWPAN_FRAG1_HDR_LEN;
+  if(uncomp_hdr_len > frag1_end || (uncomp_hdr_len & 7) != 0 || max_payload < 0) {
+    return;
+  }
+
+  /* The first fragment may grow with the new header, what does not fit
+   * into it is sent in an additional FRAGN */
+  end = uncomp_hdr_len + (max_payload & 0xfff8);
+  if(end > frag1_end) {
+    end = frag1_end;
+  }
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | ctx->size));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, my_tag);
+  packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  PRINTFO("sicslowpan output: relay first fragment (len %d, tag %d)\n\r",
+          end - uncomp_hdr_len, my_tag);
+  memcpy(packetbuf_ptr + packetbuf_hdr_len,
+         (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, end - uncomp_hdr_len);
+  packetbuf_set_datalen(end - uncomp_hdr_len + packetbuf_hdr_len);
+  send_packet(&dest);
+  if((last_tx_status == MAC_TX_COLLISION) ||
+     (last_tx_status == MAC_TX_ERR) ||
+     (last_tx_status == MAC_TX_ERR_FATAL)) {
+    PRINTFO("error in fragment tx, dropping subsequent fragments.\n\r");
+    goto drop;
+  }
+
+  linkaddr_copy(&vrb->sender, &ctx->sender);
+  vrb->tag = ctx->tag;
+  vrb->size = ctx->size;
+  /* the first fragment and those before it are relayed below */
+  vrb->received = ctx->received;
+  memcpy(vrb->blocks, ctx->blocks, sizeof(vrb->blocks));
+  linkaddr_copy(&vrb->nexthop, &dest);
+  vrb->out_tag = my_tag++;
+  timer_set(&vrb->timer, SICSLOWPAN_REASS_MAXAGE * bsp_get(E_BSP_GET_TRES));
+  reass_stats.forwarded++;
+
+  if(end < frag1_end &&
+     !send_fragn(&dest, vrb->size, vrb->out_tag, end,
+                 (uint8_t *)UIP_IP_BUF + end, frag1_end - end)) {
+    vrb->size = 0;
+    goto drop;
+  }
+
+  /* Relay the fragments that arrived before the first one */
+  block = frag1_end >> 3;
+  while(block < ((ctx->size + 7) >> 3)) {
+    if((ctx->blocks[block >> 3] & (1 << (block & 7))) == 0) {
+      block++;
+      continue;
+    }
+    start = block << 3;
+    while(block < ((ctx->size + 7) >> 3) &&
+          (ctx->blocks[block >> 3] & (1 << (block & 7))) != 0) {
+      block++;
+    }
+    end = (block << 3) < ctx->size ? (block << 3) : ctx->size;
+    if(!send_fragn(&dest, vrb->size, vrb->out_tag, start,
+                   (uint8_t *)hdr + start, end - start)) {
+      vrb->size = 0;
+      goto drop;
+    }
+  }
+  if(vrb->received >= ((vrb->size + 7) >> 3)) {
+    vrb->size = 0;
+  }
+
+drop:
+  ctx->size = 0;
+  uip_len = 0;
+  uip_ext_len = 0;
+}
+#endif /* SICSLOWPAN_VRB */
+#endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *  \param r The MAC layer
@@ -1608,6 +2146,12 @@ static uint8_t output(const uip_lladdr_t *localdest)
  *  copied in siclowpan_buf. If the IP packet is complete it is copied
  *  to uip_buf and the IP layer is called.
  *
+ *  Non-fragmented packets are uncompressed straight into uip_buf.
+ *  Fragments go to the reassembly context of their datagram, so up to
+ *  SICSLOWPAN_REASS_CONTEXTS datagrams can be merged at the same time.
+ *  Fragments may arrive in any order; a bitmap of the 8 byte blocks
+ *  received tells when the datagram is complete.
+ *
  * \note We do not check for overlapping sicslowpan fragments
  * (it is a SHALL in the RFC 4944 and should never happen)
  */
@@ -1618,11 +2162,18 @@ input(void)
   uint16_t frag_size = 0;
   /* offset of the fragment in the IP packet */
   uint8_t frag_offset = 0;
-  uint8_t is_fragment = 0;
 #if SICSLOWPAN_CONF_FRAG
   /* tag of the fragment */
   uint16_t frag_tag = 0;
-  uint8_t first_fragment = 0, last_fragment = 0;
+  /* end of the fragment in the IP packet */
+  uint16_t frag_end;
+  /* reassembly context of the fragment */
+  struct sicslowpan_reass *ctx = NULL;
+  uint8_t first_fragment = 0;
+#if SICSLOWPAN_VRB
+  /* virtual reassembly buffer of the fragment */
+  struct sicslowpan_vrb *vrb;
+#endif /* SICSLOWPAN_VRB */
 #endif /*SICSLOWPAN_CONF_FRAG*/
 
   /* init */
@@ -1637,11 +2188,9 @@ input(void)
   last_rssi = (signed short)packetbuf_attr(PACKETBUF_ATTR_RSSI);
 
 #if SICSLOWPAN_CONF_FRAG
-  /* if reassembly timed out, cancel it */
-  if(timer_expired(&reass_timer)) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  }
+  /* cancel the reassemblies that timed out */
+  reass_expire();
+  sicslowpan_buf = uip_buf;
   /*
    * Since we don't support the mesh and broadcast header, the first header
    * we look for is the fragmentation header
@@ -1657,9 +2206,7 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n\r",
              frag_size, frag_tag, frag_offset);
       packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
-      /*      printf("frag1 %d %d\n\r", reass_tag, frag_tag);*/
       first_fragment = 1;
-      is_fragment = 1;
       break;
     case SICSLOWPAN_DISPATCH_FRAGN:
       /*
@@ -1673,81 +2220,61 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n\r",
              frag_size, frag_tag, frag_offset);
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
-
-      /* If this is the last fragment, we may shave off any extrenous
-         bytes at the end. We must be liberal in what we accept. */
-      PRINTFI("last_fragment?: processed_ip_in_len %d packetbuf_payload_len %d frag_size %d\n\r",
-              processed_ip_in_len, packetbuf_datalen() - packetbuf_hdr_len, frag_size);
-
-      if(processed_ip_in_len + packetbuf_datalen() - packetbuf_hdr_len >= frag_size) {
-        last_fragment = 1;
-      }
-      is_fragment = 1;
       break;
     default:
       break;
   }
 
-  /* We are currently reassembling a packet, but have just received the first
-   * fragment of another packet. We can either ignore it and hope to receive
-   * the rest of the under-reassembly packet fragments, or we can discard the
-   * previous packet altogether, and start reassembling the new packet.
-   *
-   * We discard the previous packet, and start reassembling the new packet.
-   * This lessens the negative impacts of too high SICSLOWPAN_REASS_MAXAGE.
-   */
-#define PRIORITIZE_NEW_PACKETS 1
-#if PRIORITIZE_NEW_PACKETS
-  if(!is_fragment) {
-    /* Prioritize non-fragment packets too. */
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  } else if(processed_ip_in_len > 0 && first_fragment
-      && !linkaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  }
-#endif /* PRIORITIZE_NEW_PACKETS */
-
-  if(processed_ip_in_len > 0) {
-    /* reassembly is ongoing */
-    /*    printf("frag %d %d\n\r", reass_tag, frag_tag);*/
-    if((frag_size > 0 &&
-        (frag_size != sicslowpan_len ||
-         reass_tag  != frag_tag ||
-         !linkaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))))  ||
-       frag_size == 0) {
-      /*
-       * the packet is a fragment that does not belong to the packet
-       * being reassembled or the packet is not a fragment.
-       */
-      PRINTFI("sicslowpan input: Dropping 6lowpan packet that is not a fragment of the packet currently being reassembled\n\r");
+  if(packetbuf_hdr_len > 0) {
+    if(frag_size == 0 || frag_size > UIP_BUFSIZE - UIP_LLH_LEN ||
+       (uint16_t)(frag_offset << 3) >= frag_size) {
+      PRINTFI("sicslowpan input: Dropping fragment with invalid size %d\n\r",
+              frag_size);
       return;
     }
-  } else {
-    /*
-     * reassembly is off
-     * start it if we received a fragment
-     */
-    if((frag_size > 0) && (frag_size <= UIP_BUFSIZE)) {
-      /* We are currently not reassembling a packet, but have received a packet fragment
-       * that is not the first one. */
-      if(is_fragment && !first_fragment) {
-        return;
+#if SICSLOWPAN_VRB
+    if((vrb = vrb_lookup(frag_size, frag_tag)) != NULL) {
+      if(!first_fragment && packetbuf_datalen() > packetbuf_hdr_len) {
+        /* relay the fragment to the next hop of the datagram */
+        packetbuf_payload_len = packetbuf_datalen() - packetbuf_hdr_len;
+        if((frag_offset << 3) + packetbuf_payload_len > frag_size) {
+          packetbuf_payload_len = frag_size - (frag_offset << 3);
+        }
+        /* link layer retransmissions may repeat a fragment */
+        if(!frag_mark(vrb->blocks, &vrb->received, vrb->size, frag_offset << 3,
+                      (frag_offset << 3) + packetbuf_payload_len)) {
+          PRINTFI("sicslowpan input: Dropping duplicate fragment (offset %d)\n\r",
+                  frag_offset);
+          return;
+        }
+        memcpy(uip_buf, packetbuf_ptr + packetbuf_hdr_len, packetbuf_payload_len);
+        if(!send_fragn(&vrb->nexthop, vrb->size, vrb->out_tag, frag_offset << 3,
+                       uip_buf, packetbuf_payload_len) ||
+           vrb->received >= ((vrb->size + 7) >> 3)) {
+          vrb->size = 0;
+        }
+        uip_len = 0;
+        uip_ext_len = 0;
       }
-
-      sicslowpan_len = frag_size;
-      reass_tag = frag_tag;
-      timer_set(&reass_timer, SICSLOWPAN_REASS_MAXAGE * bsp_get(E_BSP_GET_TRES));
-      PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n\r",
-             sicslowpan_len, reass_tag);
-      linkaddr_copy(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+      return;
+    }
+#endif /* SICSLOWPAN_VRB */
+    /* Only a first fragment may take over the context of another
+     * datagram, a stray FRAGN must not kill a reassembly in progress */
+    ctx = reass_lookup(frag_size, frag_tag, first_fragment);
+    if(ctx == NULL) {
+      PRINTFI("sicslowpan input: Dropping fragment, no reassembly context available\n\r");
+      return;
+    }
+    sicslowpan_buf = ctx->buf.u8;
+    if(!first_fragment) {
+      /* this is a FRAGN, skip the header compression dispatch section */
+      goto copypayload;
+    }
+    if((ctx->blocks[0] & 1) != 0) {
+      PRINTFI("sicslowpan input: Dropping duplicate FRAG1\n\r");
+      return;
     }
-  }
-
-  if(packetbuf_hdr_len == SICSLOWPAN_FRAGN_HDR_LEN) {
-    /* this is a FRAGN, skip the header compression dispatch section */
-    goto copypayload;
   }
 #endif /* SICSLOWPAN_CONF_FRAG */
 
@@ -1782,8 +2309,8 @@ input(void)
              PACKETBUF_HC1_PTR[PACKETBUF_HC1_DISPATCH]);
       return;
   }
-   
-    
+
+
 #if SICSLOWPAN_CONF_FRAG
  copypayload:
 #endif /*SICSLOWPAN_CONF_FRAG*/
@@ -1800,81 +2327,96 @@ input(void)
   }
   packetbuf_payload_len = packetbuf_datalen() - packetbuf_hdr_len;
 
+#if SICSLOWPAN_CONF_FRAG
+  if(ctx != NULL) {
+    /* For the last fragment, we are OK if there is extrenous bytes at
+       the end of the packet. */
+    frag_end = uncomp_hdr_len + (uint16_t)(frag_offset << 3) + packetbuf_payload_len;
+    if(frag_end > ctx->size) {
+      packetbuf_payload_len -= frag_end - ctx->size;
+      frag_end = ctx->size;
+    }
+    if(!reass_mark(ctx, (uint16_t)(frag_offset << 3), frag_end)) {
+      PRINTFI("sicslowpan input: Dropping duplicate fragment (offset %d)\n\r",
+              frag_offset);
+      return;
+    }
+  }
+#endif /* SICSLOWPAN_CONF_FRAG */
+
   /* Sanity-check size of incoming packet to avoid buffer overflow */
   {
     int req_size = UIP_LLH_LEN + uncomp_hdr_len + (uint16_t)(frag_offset << 3)
         + packetbuf_payload_len;
-    if(req_size > sizeof(sicslowpan_buf)) {
+    if(req_size > UIP_BUFSIZE) {
       PRINTF(
           "SICSLOWPAN: packet dropped, minimum required SICSLOWPAN_IP_BUF size: %d+%d+%d+%d=%d (current size: %d)\n\r",
           UIP_LLH_LEN, uncomp_hdr_len, (uint16_t)(frag_offset << 3),
-          packetbuf_payload_len, req_size, sizeof(sicslowpan_buf));
+          packetbuf_payload_len, req_size, UIP_BUFSIZE);
       return;
     }
   }
 
   memcpy((uint8_t *)SICSLOWPAN_IP_BUF + uncomp_hdr_len + (uint16_t)(frag_offset << 3), packetbuf_ptr + packetbuf_hdr_len, packetbuf_payload_len);
-  
-  /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
 
 #if SICSLOWPAN_CONF_FRAG
-  if(frag_size > 0) {
-    /* Add the size of the header only for the first fragment. */
-    if(first_fragment != 0) {
-      processed_ip_in_len += uncomp_hdr_len;
-    }
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
-    if(last_fragment != 0) {
-      processed_ip_in_len = frag_size;
-    } else {
-      processed_ip_in_len += packetbuf_payload_len;
+  if(ctx != NULL) {
+    PRINTF("received %d of %d blocks\n\r", ctx->received, (ctx->size + 7) >> 3);
+    /*
+     * If we have a full IP packet in the reassembly context, deliver it
+     * to the IP stack
+     */
+    if(ctx->received < ((ctx->size + 7) >> 3)) {
+#if SICSLOWPAN_VRB
+      if(first_fragment) {
+        vrb_forward(ctx, frag_end);
+      }
+#endif /* SICSLOWPAN_VRB */
+      return;
     }
-    PRINTF("processed_ip_in_len %d, packetbuf_payload_len %d\n\r", processed_ip_in_len, packetbuf_payload_len);
-
-  } else {
-#endif /* SICSLOWPAN_CONF_FRAG */
-    sicslowpan_len = packetbuf_payload_len + uncomp_hdr_len;
-#if SICSLOWPAN_CONF_FRAG
-  }
-
-  /*
-   * If we have a full IP packet in sicslowpan_buf, deliver it to
-   * the IP stack
-   */
-  PRINTF("sicslowpan_init processed_ip_in_len %d, sicslowpan_len %d\n\r",
-         processed_ip_in_len, sicslowpan_len);
-  if(processed_ip_in_len == 0 || (processed_ip_in_len == sicslowpan_len)) {
     PRINTFI("sicslowpan input: IP packet ready (length %d)\n\r",
-           sicslowpan_len);
-    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, sicslowpan_len);
-    uip_len = sicslowpan_len;
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
+           ctx->size);
+    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, ctx->size);
+    uip_len = ctx->size;
+    ctx->size = 0;
+    reass_stats.completed++;
+  } else
 #endif /* SICSLOWPAN_CONF_FRAG */
+  {
+    uip_len = packetbuf_payload_len + uncomp_hdr_len;
+  }
 
 #if DEBUG
-    {
-      uint16_t ndx;
-      PRINTF("after decompression %u:", SICSLOWPAN_IP_BUF->len[1]);
-      for (ndx = 0; ndx < SICSLOWPAN_IP_BUF->len[1] + 40; ndx++) {
-        uint8_t data = ((uint8_t *) (SICSLOWPAN_IP_BUF))[ndx];
-        PRINTF("%02x", data);
-      }
-      PRINTF("\n\r");
+  {
+    uint16_t ndx;
+    PRINTF("after decompression %u:", UIP_IP_BUF->len[1]);
+    for (ndx = 0; ndx < UIP_IP_BUF->len[1] + 40; ndx++) {
+      uint8_t data = ((uint8_t *) (UIP_IP_BUF))[ndx];
+      PRINTF("%02x", data);
     }
+    PRINTF("\n\r");
+  }
 #endif
 
-    /* if callback is set then set attributes and call */
-    if(callback) {
-      set_packet_attrs();
-      callback->input_callback();
-    }
+  /* if callback is set then set attributes and call */
+  if(callback) {
+    set_packet_attrs();
+    callback->input_callback();
+  }
 
-    tcpip_input();
+  tcpip_input();
+}
+/*--------------------------------------------------------------------*/
+void
+sicslowpan_get_reass_stats(struct sicslowpan_reass_stats *stats)
+{
+  if(stats != NULL) {
 #if SICSLOWPAN_CONF_FRAG
-  }
+    *stats = reass_stats;
+#else /* SICSLOWPAN_CONF_FRAG */
+    memset(stats, 0, sizeof(*stats));
 #endif /* SICSLOWPAN_CONF_FRAG */
+  }
 }
 /** @} */
 
@@ -1936,6 +2478,11 @@ void sicslowpan_init(s_ns_t* p_netStack)
   }
 #endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 1 */
 
+  /* Flows compressed with the former contexts are stale */
+#if SICSLOWPAN_HC06_FLOWS > 0
+  memset(hc06_flows, 0, sizeof(hc06_flows));
+  hc06_flow_next = 0;
+#endif /* SICSLOWPAN_HC06_FLOWS > 0 */
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
 }
 /*--------------------------------------------------------------------*/
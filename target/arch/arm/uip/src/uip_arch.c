@@ -0,0 +1,166 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup uip
+ * @{
+ */
+/*! \file   arm/uip/src/uip_arch.c
+
+    \brief  Internet checksum of uIP for Cortex-M cores.
+
+            The buffer is summed as little endian 32 bit words, four
+            words per loop, into a 32 bit accumulator. The upper and
+            lower halves of each word are added separately, so the
+            accumulator can't overflow for any buffer uIP checksums
+            and the carries are only folded once at the end. Words are
+            loaded aligned as the Cortex-M0+ traps on unaligned loads.
+
+   \version 0.1
+*/
+/*============================================================================*/
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+
+#include "uip_arch.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Adds both 16 bit halves of a 32 bit word to an accumulator */
+#define CHKSUM_ADD_WORD(l_acc, l_word) \
+    (l_acc) += ((l_word) & 0xffffUL) + ((l_word) >> 16)
+
+/** Folds a 32 bit accumulator to 16 bit */
+#define CHKSUM_FOLD(l_acc) do { \
+    (l_acc) = ((l_acc) & 0xffffUL) + ((l_acc) >> 16); \
+    (l_acc) = ((l_acc) & 0xffffUL) + ((l_acc) >> 16); \
+    } while (0)
+
+/** Swaps the bytes of a folded sum */
+#define CHKSUM_SWAP(l_acc) \
+    ((((l_acc) & 0xffUL) << 8) | ((l_acc) >> 8))
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+
+/*==============================================================================
+  sum_words()
+ =============================================================================*/
+static uint32_t sum_words(const uint8_t *p_data, uint16_t i_len)
+{
+    uint32_t l_acc = 0;
+    const uint32_t *pl_word;
+
+    /* p_data is 16 bit aligned, align it to 32 bit */
+    if (((uintptr_t)p_data & 2) && (i_len >= 2)) {
+        l_acc += *(const uint16_t *)p_data;
+        p_data += 2;
+        i_len -= 2;
+    }
+
+    pl_word = (const uint32_t *)p_data;
+    while (i_len >= 16) {
+        uint32_t l_w0 = pl_word[0];
+        uint32_t l_w1 = pl_word[1];
+        uint32_t l_w2 = pl_word[2];
+        uint32_t l_w3 = pl_word[3];
+        CHKSUM_ADD_WORD(l_acc, l_w0);
+        CHKSUM_ADD_WORD(l_acc, l_w1);
+        CHKSUM_ADD_WORD(l_acc, l_w2);
+        CHKSUM_ADD_WORD(l_acc, l_w3);
+        pl_word += 4;
+        i_len -= 16;
+    }
+    while (i_len >= 4) {
+        CHKSUM_ADD_WORD(l_acc, *pl_word);
+        pl_word++;
+        i_len -= 4;
+    }
+
+    p_data = (const uint8_t *)pl_word;
+    if (i_len >= 2) {
+        l_acc += *(const uint16_t *)p_data;
+        p_data += 2;
+        i_len -= 2;
+    }
+    if (i_len) {
+        /* The odd byte is the high byte of a network order word */
+        l_acc += p_data[0];
+    }
+    return l_acc;
+} /* sum_words() */
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+
+/*==============================================================================
+  uip_arch_chksum()
+ =============================================================================*/
+uint16_t uip_arch_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+    uint32_t l_acc;
+
+    if (len == 0) {
+        return sum;
+    }
+
+    if ((uintptr_t)data & 1) {
+        /* The words after the first byte are summed with swapped bytes,
+         * see RFC 1071 section 2 (B) */
+        l_acc = sum_words(data + 1, len - 1);
+        CHKSUM_FOLD(l_acc);
+        l_acc = CHKSUM_SWAP(l_acc) + data[0];
+    } else {
+        l_acc = sum_words(data, len);
+    }
+    CHKSUM_FOLD(l_acc);
+
+    /* Swap the little endian sum to host order and add the start value */
+    l_acc = CHKSUM_SWAP(l_acc) + sum;
+    CHKSUM_FOLD(l_acc);
+    return (uint16_t)l_acc;
+} /* uip_arch_chksum() */
+
+/** @} */
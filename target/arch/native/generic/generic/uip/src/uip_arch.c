@@ -0,0 +1,191 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup uip
+ * @{
+ */
+/*! \file   native/generic/generic/uip/src/uip_arch.c
+
+    \brief  Internet checksum of uIP for native hosts.
+
+            The buffer is summed as host order words into a wide
+            accumulator and folded to 16 bit only once at the end. The
+            one's complement sum is independent of the byte order of
+            the words, so the folded sum just needs to be swapped on
+            little endian hosts.
+            SSE2 and AVX2 are used if the compiler targets them.
+
+   \version 0.1
+*/
+/*============================================================================*/
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+#include <string.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "uip_arch.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define CHKSUM_ODD_BYTE(c_byte)     ((uint32_t)(c_byte) << 8)
+#define CHKSUM_NTOH(l_sum)          (l_sum)
+#else
+#define CHKSUM_ODD_BYTE(c_byte)     ((uint32_t)(c_byte))
+#define CHKSUM_NTOH(l_sum)          ((((l_sum) & 0xffUL) << 8) + ((l_sum) >> 8))
+#endif /* __BYTE_ORDER__ */
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+
+/*==============================================================================
+  sum_words()
+ =============================================================================*/
+static uint64_t sum_words(const uint8_t *p_data, uint16_t i_len)
+{
+    uint64_t l_acc = 0;
+    uint32_t l_word;
+
+#if defined(__AVX2__)
+    if (i_len >= 32) {
+        __m256i s_zero = _mm256_setzero_si256();
+        __m256i s_acc = s_zero;
+        uint32_t al_lanes[8];
+        int i;
+
+        /* Every 32 bit lane gets two 16 bit words per 32 bytes, at most
+         * 4096 words for a 64 kB buffer, which can't overflow */
+        while (i_len >= 32) {
+            __m256i s_data = _mm256_loadu_si256((const __m256i *)p_data);
+            s_acc = _mm256_add_epi32(s_acc,
+                    _mm256_unpacklo_epi16(s_data, s_zero));
+            s_acc = _mm256_add_epi32(s_acc,
+                    _mm256_unpackhi_epi16(s_data, s_zero));
+            p_data += 32;
+            i_len -= 32;
+        }
+        _mm256_storeu_si256((__m256i *)al_lanes, s_acc);
+        for (i = 0; i < 8; i++) {
+            l_acc += al_lanes[i];
+        }
+    }
+#elif defined(__SSE2__)
+    if (i_len >= 16) {
+        __m128i s_zero = _mm_setzero_si128();
+        __m128i s_acc = s_zero;
+        uint32_t al_lanes[4];
+        int i;
+
+        /* Every 32 bit lane gets two 16 bit words per 16 bytes, at most
+         * 8192 words for a 64 kB buffer, which can't overflow */
+        while (i_len >= 16) {
+            __m128i s_data = _mm_loadu_si128((const __m128i *)p_data);
+            s_acc = _mm_add_epi32(s_acc, _mm_unpacklo_epi16(s_data, s_zero));
+            s_acc = _mm_add_epi32(s_acc, _mm_unpackhi_epi16(s_data, s_zero));
+            p_data += 16;
+            i_len -= 16;
+        }
+        _mm_storeu_si128((__m128i *)al_lanes, s_acc);
+        for (i = 0; i < 4; i++) {
+            l_acc += al_lanes[i];
+        }
+    }
+#endif /* __AVX2__ */
+
+    /* A 64 bit accumulator takes 2^32 words before it could carry out */
+    while (i_len >= 8) {
+        uint32_t l_hi;
+        memcpy(&l_word, p_data, 4);
+        memcpy(&l_hi, p_data + 4, 4);
+        l_acc += (uint64_t)l_word + l_hi;
+        p_data += 8;
+        i_len -= 8;
+    }
+    if (i_len >= 4) {
+        memcpy(&l_word, p_data, 4);
+        l_acc += l_word;
+        p_data += 4;
+        i_len -= 4;
+    }
+    if (i_len >= 2) {
+        uint16_t i_half;
+        memcpy(&i_half, p_data, 2);
+        l_acc += i_half;
+        p_data += 2;
+        i_len -= 2;
+    }
+    if (i_len) {
+        /* The odd byte is the high byte of a network order word */
+        l_acc += CHKSUM_ODD_BYTE(p_data[0]);
+    }
+    return l_acc;
+} /* sum_words() */
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+
+/*==============================================================================
+  uip_arch_chksum()
+ =============================================================================*/
+uint16_t uip_arch_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+    uint64_t l_acc = sum_words(data, len);
+
+    /* Fold the carries back into the low 16 bit */
+    l_acc = (l_acc & 0xffffffffUL) + (l_acc >> 32);
+    l_acc = (l_acc & 0xffffUL) + (l_acc >> 16);
+    l_acc = (l_acc & 0xffffUL) + (l_acc >> 16);
+    l_acc = (l_acc & 0xffffUL) + (l_acc >> 16);
+
+    /* Swap the sum to network order and add the start value */
+    l_acc = CHKSUM_NTOH(l_acc) + sum;
+    l_acc = (l_acc & 0xffffUL) + (l_acc >> 16);
+    return (uint16_t)l_acc;
+} /* uip_arch_chksum() */
+
+/** @} */
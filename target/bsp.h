@@ -258,6 +258,18 @@ uint16_t bsp_led(en_bspLedColor_t ui_led, en_bspLedAction_t en_ledAction);
  */
 /*============================================================================*/
 #define        bsp_delay_us(i_delay)           hal_delay_us(i_delay)
+/*============================================================================*/
+/** \brief  This function waits on the target until a deadline or a wake up
+ *          source
+ *
+ *  \param  l_deadline  Tick value to wake up at
+ *  \param  c_wakeSrc   Mask of HAL_WAKE_x sources
+ *  \return Source which ended the wait
+ *
+ */
+/*============================================================================*/
+#define        bsp_waitUntil(l_deadline, c_wakeSrc) \
+                                            hal_waitUntil(l_deadline, c_wakeSrc)
 
 /*============================================================================*/
 /** \brief  This function initialize a specific pin
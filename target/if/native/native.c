@@ -48,7 +48,11 @@
 
  \brief  Fake radio transceiver based on LCM IPC.
 
- \version 1.1
+         In tickless mode the LCM descriptor is watched by the native
+         hal_waitUntil(), otherwise it is polled by an event timer. In both
+         cases every queued frame is handled once the descriptor is readable.
+
+ \version 1.2
  */
 /*============================================================================*/
 
@@ -61,6 +65,7 @@
 #include "packetbuf.h"
 #include "tcpip.h"
 #include "etimer.h"
+#include "hwinit.h"
 #include <errno.h>
 #include <sys/time.h>
 #include <stdio.h>
@@ -82,7 +87,9 @@
 /*==============================================================================
  VARIABLE DECLARATIONS
  ==============================================================================*/
+#if !EMB6_TICKLESS
 static struct etimer ps_nativeTmr;
+#endif /* !EMB6_TICKLESS */
 /* Pointer to the lmac structure */
 static s_nsLowMac_t* p_lmac = NULL;
 extern uip_lladdr_t uip_lladdr;
@@ -102,7 +109,12 @@ static int8_t _native_init( s_ns_t* p_netStack );
 static int8_t _native_send( const void *pr_payload, uint8_t c_len );
 static void _native_read( const lcm_recv_buf_t *rbuf, const char * channel,
         void * p_macAddr );
+static void _native_drain( void );
+#if EMB6_TICKLESS
+static void _native_fdHandler( void * p_fd );
+#else
 static void _native_handler( c_event_t c_event, p_data_t p_data );
+#endif /* EMB6_TICKLESS */
 /*==============================================================================
  STRUCTURES AND OTHER TYPEDEFS
  ==============================================================================*/
@@ -256,7 +268,14 @@ static int8_t _native_init( s_ns_t* p_netStack )
     }
 
     /* Start the packet receive process */
+#if EMB6_TICKLESS
+    if( !hal_fdWatch( lcm_get_fileno( ps_lcm ), _native_fdHandler ) )
+    {
+        _printAndExit( "Can't watch LCM descriptor" );
+    }
+#else
     etimer_set( &ps_nativeTmr, 10, _native_handler );
+#endif /* EMB6_TICKLESS */
 
     return l_error;
 } /* _native_init() */
@@ -352,44 +371,72 @@ static int8_t _native_off( void )
 } /* _native_off() */
 
 /*----------------------------------------------------------------------------*/
-/** \brief  NATIVE transport handler for periodic polling
- *          triggered every 10 msec
- *  \param  c_event       Source of an event.
- *  \param  p_data        Pointer to a data
+/** \brief  Handle every frame which is waiting on the LCM descriptor
+ *          Received frames are passed to the lower MAC back-to-back.
  *  \return void
  */
 /*----------------------------------------------------------------------------*/
-static void _native_handler( c_event_t c_event, p_data_t p_data )
+static void _native_drain( void )
 {
     int32_t lcm_fd;
     struct timeval s_tv;
-    s_tv.tv_sec = 0;
-    s_tv.tv_usec = 10;
     fd_set fds;
 
-    if( etimer_expired( &ps_nativeTmr ) )
+    lcm_fd = lcm_get_fileno( ps_lcm );
+    while( 1 )
     {
         /* We can't use lcm_handle trigger every time, as
          * it's a blocking operation. We should instead check whether a lcm file
-         * descriptor is available for reading. We put 10 usec as a timeout.
+         * descriptor is available for reading, without waiting.
          */
-        lcm_fd = lcm_get_fileno( ps_lcm );
+        s_tv.tv_sec = 0;
+        s_tv.tv_usec = 0;
         FD_ZERO( &fds );
         FD_SET( lcm_fd, &fds );
 
-        select( lcm_fd + 1, &fds, 0, 0, &s_tv );
-        /* If descriptor is available for reading then there is a incoming data
-         * to read.
-         */
-        if( FD_ISSET( lcm_fd, &fds ) )
+        if( ( select( lcm_fd + 1, &fds, 0, 0, &s_tv ) <= 0 ) ||
+            !FD_ISSET( lcm_fd, &fds ) )
+            break;
+
+        if( lcm_handle( ps_lcm ) != 0 )
         {
-            lcm_handle( ps_lcm );
+            LOG_ERR( "LCM handle failed" );
+            break;
         }
+    }
+} /* _native_drain() */
+
+#if EMB6_TICKLESS
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE transport handler called by hal_waitUntil() whenever
+ *          the LCM descriptor is readable
+ *  \param  p_fd          Pointer to the descriptor.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_fdHandler( void * p_fd )
+{
+    _native_drain();
+} /* _native_fdHandler() */
+#else
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE transport handler for periodic polling
+ *          triggered every 10 msec
+ *  \param  c_event       Source of an event.
+ *  \param  p_data        Pointer to a data
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_handler( c_event_t c_event, p_data_t p_data )
+{
+    if( etimer_expired( &ps_nativeTmr ) )
+    {
+        _native_drain();
         /* Restart a timer anyway. */
         etimer_restart( &ps_nativeTmr );
-
     }
-}
+} /* _native_handler() */
+#endif /* EMB6_TICKLESS */
 
 /*==============================================================================
  API FUNCTIONS
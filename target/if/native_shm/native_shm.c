@@ -0,0 +1,576 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \addtogroup native_shm_radio
+ * @{
+ */
+/*============================================================================*/
+/*! \file   native_shm.c
+
+ \brief  Fake radio transceiver based on shared memory rings.
+
+         Each node publishes its frames into a ring in POSIX shared memory
+         which is written by this node only. Every listener keeps a private
+         read cursor, so the ring is lock-free for a single producer and any
+         number of consumers. A slot carries the sequence number of the frame
+         it holds; a reader copies the frame and checks afterwards that the
+         sequence number was not changed by the producer in the meantime.
+         Listeners which fall behind by more than a ring lose the oldest
+         frames, just like a real radio would.
+
+         The topology is read from lcmnetwork.conf in the format used by
+         the LCM based native driver. After a frame was published the
+         sender writes one byte into the doorbell pipe of every listener.
+
+ \version 0.1
+ */
+/*============================================================================*/
+
+/*==============================================================================
+ MACROS
+ ==============================================================================*/
+#define     _POSIX_C_SOURCE               200809L
+
+/*==============================================================================
+ INCLUDE FILES
+ ==============================================================================*/
+#include "emb6.h"
+#include "emb6_conf.h"
+#include "bsp.h"
+#include "packetbuf.h"
+#include "tcpip.h"
+#include "etimer.h"
+#include "hwinit.h"
+#include "native_shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+/*==============================================================================
+ MACROS
+ ==============================================================================*/
+#define     LOGGER_ENABLE                 LOGGER_RADIO
+#include    "logger.h"
+#define     NODE_INFO_MAX                 2048
+#define     NATIVE_SHM_PATH_MAX           64
+
+/** Index of a frame number inside of a ring */
+#define     NATIVE_SHM_SLOT(l_seq)        ( (l_seq) & ( NATIVE_SHM_RING_SIZE - 1 ) )
+
+/*==============================================================================
+ STRUCTURES AND OTHER TYPEDEFS
+ ==============================================================================*/
+/** Single frame of a ring. l_seq holds the number of the frame plus one, and
+ *  is zero while the producer writes the slot. */
+typedef struct
+{
+    uint32_t l_seq;
+    uint8_t  c_len;
+    uint8_t  ac_data[NATIVE_SHM_FRAME_MAX];
+} s_shmSlot_t;
+
+/** Ring of frames transmitted by a node, placed in shared memory */
+typedef struct
+{
+    /** Number of frames published so far */
+    uint32_t l_head;
+    s_shmSlot_t as_slot[NATIVE_SHM_RING_SIZE];
+} s_shmRing_t;
+
+/** Node this node can hear */
+typedef struct
+{
+    s_shmRing_t *ps_ring;
+    /** Number of the next frame to read */
+    uint32_t l_tail;
+    uint16_t i_addr;
+} s_shmSrc_t;
+
+/** Node which shall hear this node */
+typedef struct
+{
+    /** Write end of the doorbell pipe or -1 if not yet opened */
+    int i_fd;
+    uint16_t i_addr;
+} s_shmDst_t;
+
+/*==============================================================================
+ VARIABLE DECLARATIONS
+ ==============================================================================*/
+#if !EMB6_TICKLESS
+static struct etimer ps_shmTmr;
+#endif /* !EMB6_TICKLESS */
+/* Pointer to the lmac structure */
+static s_nsLowMac_t* p_lmac = NULL;
+extern uip_lladdr_t uip_lladdr;
+/* Own ring */
+static s_shmRing_t *ps_shmTx;
+/* Read end of the own doorbell pipe */
+static int i_shmBell = -1;
+static s_shmSrc_t as_shmSrc[NATIVE_SHM_MAX_NEIGHBORS];
+static uint8_t c_shmSrcCnt;
+static s_shmDst_t as_shmDst[NATIVE_SHM_MAX_NEIGHBORS];
+static uint8_t c_shmDstCnt;
+/*==============================================================================
+ LOCAL FUNCTION PROTOTYPES
+ ==============================================================================*/
+static void _printAndExit( const char* rpc_reason );
+static s_shmRing_t* _native_shm_map( uint16_t i_addr );
+static void _native_shm_bellPath( char* pc_path, uint16_t i_addr );
+static int8_t _native_shm_on( void );
+static int8_t _native_shm_off( void );
+static int8_t _native_shm_init( s_ns_t* p_netStack );
+static int8_t _native_shm_send( const void *pr_payload, uint8_t c_len );
+static void _native_shm_read( s_shmSrc_t* ps_src );
+static void _native_shm_drain( void );
+#if EMB6_TICKLESS
+static void _native_shm_fdHandler( void * p_fd );
+#else
+static void _native_shm_handler( c_event_t c_event, p_data_t p_data );
+#endif /* EMB6_TICKLESS */
+/*==============================================================================
+ GLOBAL CONSTANTS
+ ==============================================================================*/
+const s_nsIf_t native_shm_driver = {
+        "native_shm_driver",
+        _native_shm_init,
+        _native_shm_send,
+        _native_shm_on,
+        _native_shm_off, };
+/*==============================================================================
+ LOCAL FUNCTIONS
+ ==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  This function reports the error and exits back to the shell.
+ *
+ *  \param  rpc_reason  Error to show
+ *  \return Node
+ */
+/*----------------------------------------------------------------------------*/
+static void _printAndExit( const char* rpc_reason )
+{
+    fputs( strerror( errno ), stderr );
+    fputs( ": ", stderr );
+    fputs( rpc_reason, stderr );
+    fputc( '\n', stderr );
+    exit( 1 );
+}
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Map the ring of a node, creating it if the node is not running yet.
+ *          A freshly created object is zero filled which is a valid empty
+ *          ring, hence no further initialization is required.
+ *
+ *  \param  i_addr        Address of the node owning the ring.
+ *  \return Pointer to the mapped ring.
+ */
+/*----------------------------------------------------------------------------*/
+static s_shmRing_t* _native_shm_map( uint16_t i_addr )
+{
+    char pc_name[NATIVE_SHM_PATH_MAX];
+    void *p_ring;
+    int i_fd;
+
+    snprintf( pc_name, sizeof( pc_name ), "/%s_%04X", NATIVE_SHM_NAME, i_addr );
+    i_fd = shm_open( pc_name, O_CREAT | O_RDWR, 0666 );
+    if( i_fd < 0 )
+        _printAndExit( "Can't open shared memory ring" );
+
+    if( ftruncate( i_fd, sizeof( s_shmRing_t ) ) != 0 )
+        _printAndExit( "Can't resize shared memory ring" );
+
+    p_ring = mmap( NULL, sizeof( s_shmRing_t ), PROT_READ | PROT_WRITE,
+            MAP_SHARED, i_fd, 0 );
+    if( p_ring == MAP_FAILED )
+        _printAndExit( "Can't map shared memory ring" );
+
+    /* The mapping stays valid after the descriptor was closed */
+    close( i_fd );
+    return (s_shmRing_t *)p_ring;
+} /* _native_shm_map() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Assemble the path of the doorbell pipe of a node
+ *
+ *  \param  pc_path       Buffer of NATIVE_SHM_PATH_MAX bytes.
+ *  \param  i_addr        Address of the node.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_shm_bellPath( char* pc_path, uint16_t i_addr )
+{
+    snprintf( pc_path, NATIVE_SHM_PATH_MAX, "/tmp/%s_%04X", NATIVE_SHM_NAME,
+            i_addr );
+} /* _native_shm_bellPath() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport initialization
+ *
+ *  \param  p_netStack    Pointer to s network stack.
+ *  \return int8_t        Status code.
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_shm_init( s_ns_t* p_netStack )
+{
+    linkaddr_t un_addr;
+    uint8_t l_error;
+    FILE* fp;
+    char pc_node_info[NODE_INFO_MAX];
+    char pc_path[NATIVE_SHM_PATH_MAX];
+    char* pch;
+    uint16_t i_own;
+    uint16_t addr;
+    uint16_t i_nbr;
+    uint8_t  c_heard;
+
+    LOG_INFO( "Try to initialize shared memory native radio driver" );
+
+    i_own = ( (uint16_t)mac_phy_config.mac_address[6] << 8 ) |
+            mac_phy_config.mac_address[7];
+
+    /* A listener which went away must not kill the sender */
+    signal( SIGPIPE, SIG_IGN );
+
+    /* Read configuration file */
+    fp = fopen( "lcmnetwork.conf", "r" );
+
+    if( fp == NULL )
+    {
+        _printAndExit( "Can't open this file\n" );
+    }
+
+    while( !feof(fp) )
+    {
+        memset(pc_node_info, 0, NODE_INFO_MAX);
+        fgets( pc_node_info, NODE_INFO_MAX, fp );
+        if( pc_node_info[0] == '#' ) continue;
+
+        pch = strtok (pc_node_info," \t\n,");
+        if( pch == NULL ) continue;
+
+        /* get address of the transmitting node */
+        sscanf( pch, "%hx", &addr );
+        c_heard = 0;
+
+        /* walk through the nodes which shall hear it */
+        for( pch = strtok( NULL, " \t\n," ); pch != NULL;
+             pch = strtok( NULL, " \t\n," ) )
+        {
+            sscanf( pch, "%hx", &i_nbr );
+            if( addr == i_own )
+            {
+                if( c_shmDstCnt == NATIVE_SHM_MAX_NEIGHBORS )
+                    _printAndExit( "Too many listeners" );
+                as_shmDst[c_shmDstCnt].i_addr = i_nbr;
+                as_shmDst[c_shmDstCnt].i_fd = -1;
+                c_shmDstCnt++;
+            }
+            else if( i_nbr == i_own )
+            {
+                c_heard = 1;
+            }
+        }
+
+        if( c_heard )
+        {
+            if( c_shmSrcCnt == NATIVE_SHM_MAX_NEIGHBORS )
+                _printAndExit( "Too many transmitters" );
+            as_shmSrc[c_shmSrcCnt].i_addr = addr;
+            as_shmSrc[c_shmSrcCnt].ps_ring = _native_shm_map( addr );
+            /* Frames sent before we were listening are never received */
+            as_shmSrc[c_shmSrcCnt].l_tail = __atomic_load_n(
+                    &as_shmSrc[c_shmSrcCnt].ps_ring->l_head, __ATOMIC_ACQUIRE );
+            c_shmSrcCnt++;
+            fprintf( stderr, "\n listen to 0x%04X", addr );
+        }
+    }
+
+    /* Close the file */
+    fclose(fp);
+
+    /* Own ring keeps its head if the node was restarted, so listeners
+     * which are still running continue seamlessly. */
+    ps_shmTx = _native_shm_map( i_own );
+
+    /* The doorbell is opened for reading and writing, which keeps the pipe
+     * from signaling end of file when all the senders are gone. */
+    _native_shm_bellPath( pc_path, i_own );
+    if( ( mkfifo( pc_path, 0666 ) != 0 ) && ( errno != EEXIST ) )
+        _printAndExit( "Can't create doorbell" );
+    i_shmBell = open( pc_path, O_RDWR | O_NONBLOCK );
+    if( i_shmBell < 0 )
+        _printAndExit( "Can't open doorbell" );
+
+    fprintf( stderr, "\n addr=0x%04X, %d listeners, %d transmitters\n", i_own,
+            c_shmDstCnt, c_shmSrcCnt );
+
+    LOG_INFO( "native shm driver was initialized" );
+
+    /* Initialise global lladdr structure with a given mac */
+    memcpy( (void *)&un_addr.u8, &mac_phy_config.mac_address, 8 );
+    memcpy( &uip_lladdr.addr, &un_addr.u8, 8 );
+    linkaddr_set_node_addr( &un_addr );
+
+    LOG_INFO( "MAC address %x:%x:%x:%x:%x:%x:%x:%x", un_addr.u8[0],
+            un_addr.u8[1], un_addr.u8[2], un_addr.u8[3], un_addr.u8[4],
+            un_addr.u8[5], un_addr.u8[6], un_addr.u8[7] );
+
+    if( p_netStack->lmac != NULL )
+    {
+        p_lmac = p_netStack->lmac;
+        l_error = 1;
+    }
+    else
+    {
+        _printAndExit( "Bad lmac pointer" );
+    }
+
+    /* Start the packet receive process */
+#if EMB6_TICKLESS
+    if( !hal_fdWatch( i_shmBell, _native_shm_fdHandler ) )
+    {
+        _printAndExit( "Can't watch doorbell" );
+    }
+#else
+    etimer_set( &ps_shmTmr, 1, _native_shm_handler );
+#endif /* EMB6_TICKLESS */
+
+    return l_error;
+} /* _native_shm_init() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport message send
+ *          The frame is published in the own ring and every listener is
+ *          notified through its doorbell.
+ *  \param  pr_payload    Pointer to a payload.
+ *  \param  c_len         Length of a payload
+ *  \return int8_t        Status code.
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_shm_send( const void *pr_payload, uint8_t c_len )
+{
+    char pc_path[NATIVE_SHM_PATH_MAX];
+    s_shmSlot_t *ps_slot;
+    s_shmDst_t *ps_dst;
+    uint32_t l_head;
+    uint8_t c_bell = 1;
+    uint8_t i;
+
+    /* We are the only writer of the ring */
+    l_head = ps_shmTx->l_head;
+    ps_slot = &ps_shmTx->as_slot[NATIVE_SHM_SLOT( l_head )];
+
+    /* Invalidate the slot before it is overwritten, then publish it */
+    __atomic_store_n( &ps_slot->l_seq, 0, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    memcpy( ps_slot->ac_data, pr_payload, c_len );
+    ps_slot->c_len = c_len;
+    __atomic_store_n( &ps_slot->l_seq, l_head + 1, __ATOMIC_RELEASE );
+    __atomic_store_n( &ps_shmTx->l_head, l_head + 1, __ATOMIC_RELEASE );
+
+    for( i = 0; i < c_shmDstCnt; i++ )
+    {
+        ps_dst = &as_shmDst[i];
+        if( ps_dst->i_fd < 0 )
+        {
+            /* Fails as long as the listener is not running */
+            _native_shm_bellPath( pc_path, ps_dst->i_addr );
+            ps_dst->i_fd = open( pc_path, O_WRONLY | O_NONBLOCK );
+            if( ps_dst->i_fd < 0 )
+                continue;
+        }
+
+        /* A full pipe means that the listener is woken up anyway */
+        if( ( write( ps_dst->i_fd, &c_bell, 1 ) < 0 ) && ( errno == EPIPE ) )
+        {
+            close( ps_dst->i_fd );
+            ps_dst->i_fd = -1;
+        }
+    }
+
+    LOG_OK( "TX packet [%d]", c_len );
+    LOG2_HEXDUMP( pr_payload, c_len );
+    return RADIO_TX_OK;
+} /* _native_shm_send() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport message reception
+ *          Pass every frame of a transmitter which was not read yet to the
+ *          lower MAC.
+ *  \param  ps_src        Transmitter to read from.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_shm_read( s_shmSrc_t* ps_src )
+{
+    s_shmRing_t *ps_ring = ps_src->ps_ring;
+    s_shmSlot_t *ps_slot;
+    uint32_t l_head;
+    uint32_t l_seq;
+    uint8_t c_len;
+
+    l_head = __atomic_load_n( &ps_ring->l_head, __ATOMIC_ACQUIRE );
+
+    /* The transmitter was restarted with an empty ring */
+    if( (int32_t)( l_head - ps_src->l_tail ) < 0 )
+        ps_src->l_tail = l_head;
+
+    /* The oldest frames were overwritten already */
+    if( ( l_head - ps_src->l_tail ) > NATIVE_SHM_RING_SIZE )
+    {
+        LOG_WARN( "Lost %lu frames of 0x%04X",
+                (unsigned long)( l_head - ps_src->l_tail - NATIVE_SHM_RING_SIZE ),
+                ps_src->i_addr );
+        ps_src->l_tail = l_head - NATIVE_SHM_RING_SIZE;
+    }
+
+    while( ps_src->l_tail != l_head )
+    {
+        ps_slot = &ps_ring->as_slot[NATIVE_SHM_SLOT( ps_src->l_tail )];
+        ps_src->l_tail++;
+
+        if( __atomic_load_n( &ps_slot->l_seq, __ATOMIC_ACQUIRE ) !=
+            ps_src->l_tail )
+            continue;
+
+        packetbuf_clear();
+        c_len = ps_slot->c_len;
+        if( c_len > PACKETBUF_SIZE )
+            c_len = PACKETBUF_SIZE;
+        memcpy( packetbuf_dataptr(), ps_slot->ac_data, c_len );
+
+        /* Drop the frame if the producer overwrote it while copying */
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        l_seq = __atomic_load_n( &ps_slot->l_seq, __ATOMIC_RELAXED );
+        if( ( l_seq != ps_src->l_tail ) || ( c_len == 0 ) )
+        {
+            LOG_ERR( "Failed to receive packet" );
+            continue;
+        }
+
+        LOG_OK( "RX packet [%d]", c_len );
+        LOG2_HEXDUMP( packetbuf_dataptr(), c_len );
+        if( p_lmac != NULL )
+        {
+            packetbuf_set_datalen( c_len );
+            p_lmac->input();
+        }
+    }
+} /* _native_shm_read() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport wrapper function
+ *  \return 0
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_shm_on( void )
+{
+    return 0;
+} /* _native_shm_on() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport wrapper function
+ *  \return 0
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_shm_off( void )
+{
+    return 0;
+} /* _native_shm_off() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  Handle every frame which is waiting in the rings of the nodes
+ *          we can hear. The doorbell is emptied first, so a frame published
+ *          while the rings are scanned rings the bell again.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_shm_drain( void )
+{
+    uint8_t ac_bell[64];
+    uint8_t i;
+
+    while( read( i_shmBell, ac_bell, sizeof( ac_bell ) ) > 0 );
+
+    for( i = 0; i < c_shmSrcCnt; i++ )
+    {
+        _native_shm_read( &as_shmSrc[i] );
+    }
+} /* _native_shm_drain() */
+
+#if EMB6_TICKLESS
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport handler called by hal_waitUntil() whenever
+ *          the doorbell is readable
+ *  \param  p_fd          Pointer to the descriptor.
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_shm_fdHandler( void * p_fd )
+{
+    _native_shm_drain();
+} /* _native_shm_fdHandler() */
+#else
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SHM transport handler for periodic polling
+ *          triggered every tick
+ *  \param  c_event       Source of an event.
+ *  \param  p_data        Pointer to a data
+ *  \return void
+ */
+/*----------------------------------------------------------------------------*/
+static void _native_shm_handler( c_event_t c_event, p_data_t p_data )
+{
+    if( etimer_expired( &ps_shmTmr ) )
+    {
+        _native_shm_drain();
+        /* Restart a timer anyway. */
+        etimer_restart( &ps_shmTmr );
+    }
+} /* _native_shm_handler() */
+#endif /* EMB6_TICKLESS */
+
+/*==============================================================================
+ API FUNCTIONS
+ ==============================================================================*/
+/** @} */
@@ -0,0 +1,92 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \addtogroup bsp
+ * @{
+ * \addtogroup if    PHY interfaces
+ * @{ */
+
+/**
+ * \defgroup native_shm_radio PC based shared memory radio transceiver
+ *
+ * Every node owns a ring of frames in POSIX shared memory. The node is the
+ * only writer of its ring, while every node which shall hear it (as
+ * described in lcmnetwork.conf) reads the ring with its own private cursor.
+ * A named pipe per node is used as doorbell to wake up the listeners.
+ *
+ * @{
+ */
+/*
+ * native_shm.h
+ *
+ *  Created on: Oct, 2026
+ */
+
+#ifndef NATIVE_SHM_RADIO_H_
+#define NATIVE_SHM_RADIO_H_
+
+/** Number of frames kept in the ring of a node, must be a power of two */
+#ifdef NATIVE_SHM_CONF_RING_SIZE
+#define NATIVE_SHM_RING_SIZE            NATIVE_SHM_CONF_RING_SIZE
+#else
+#define NATIVE_SHM_RING_SIZE            64
+#endif /* NATIVE_SHM_CONF_RING_SIZE */
+
+#if ( NATIVE_SHM_RING_SIZE & ( NATIVE_SHM_RING_SIZE - 1 ) ) != 0
+#error "NATIVE_SHM_RING_SIZE must be a power of two"
+#endif
+
+/** Maximum number of nodes a node can hear */
+#ifdef NATIVE_SHM_CONF_MAX_NEIGHBORS
+#define NATIVE_SHM_MAX_NEIGHBORS        NATIVE_SHM_CONF_MAX_NEIGHBORS
+#else
+#define NATIVE_SHM_MAX_NEIGHBORS        16
+#endif /* NATIVE_SHM_CONF_MAX_NEIGHBORS */
+
+/** Maximum length of a frame stored in the ring */
+#define NATIVE_SHM_FRAME_MAX            255
+
+/** Prefix of the shared memory objects and of the doorbell pipes */
+#define NATIVE_SHM_NAME                 "emb6_shm"
+
+#endif /* NATIVE_SHM_RADIO_H_ */
+/** @} */
+/** @} */
+/** @} */
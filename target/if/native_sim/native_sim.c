@@ -0,0 +1,187 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \addtogroup native_sim_radio
+ * @{
+ */
+/*============================================================================*/
+/*! \file   native_sim.c
+
+ \brief  Radio transceiver of a node which runs inside of the emb6 simulator.
+
+         The address of the node is assigned by the simulator and overrides
+         the last two bytes of the configured MAC address.
+
+ \version 0.1
+ */
+/*============================================================================*/
+
+/*==============================================================================
+ INCLUDE FILES
+ ==============================================================================*/
+#include "emb6.h"
+#include "emb6_conf.h"
+#include "bsp.h"
+#include "packetbuf.h"
+#include "hwinit.h"
+#include "sim.h"
+/*==============================================================================
+ MACROS
+ ==============================================================================*/
+#define     LOGGER_ENABLE                 LOGGER_RADIO
+#include    "logger.h"
+
+/*==============================================================================
+ VARIABLE DECLARATIONS
+ ==============================================================================*/
+/* Pointer to the lmac structure */
+static s_nsLowMac_t* p_lmac = NULL;
+extern uip_lladdr_t uip_lladdr;
+/*==============================================================================
+ LOCAL FUNCTION PROTOTYPES
+ ==============================================================================*/
+static int8_t _native_sim_on( void );
+static int8_t _native_sim_off( void );
+static int8_t _native_sim_init( s_ns_t* p_netStack );
+static int8_t _native_sim_send( const void *pr_payload, uint8_t c_len );
+/*==============================================================================
+ GLOBAL CONSTANTS
+ ==============================================================================*/
+const s_nsIf_t native_sim_driver = {
+        "native_sim_driver",
+        _native_sim_init,
+        _native_sim_send,
+        _native_sim_on,
+        _native_sim_off, };
+/*==============================================================================
+ LOCAL FUNCTIONS
+ ==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SIM transport initialization
+ *
+ *  \param  p_netStack    Pointer to s network stack.
+ *  \return int8_t        Status code.
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_sim_init( s_ns_t* p_netStack )
+{
+    linkaddr_t un_addr;
+    uint16_t i_addr = sim_hostNodeAddr();
+
+    if( p_netStack->lmac == NULL )
+    {
+        LOG_ERR( "Bad lmac pointer" );
+        return 0;
+    }
+    p_lmac = p_netStack->lmac;
+
+    mac_phy_config.mac_address[6] = (uint8_t)( i_addr >> 8 );
+    mac_phy_config.mac_address[7] = (uint8_t)i_addr;
+
+    /* Initialise global lladdr structure with a given mac */
+    memcpy( (void *)&un_addr.u8, &mac_phy_config.mac_address, 8 );
+    memcpy( &uip_lladdr.addr, &un_addr.u8, 8 );
+    linkaddr_set_node_addr( &un_addr );
+
+    LOG_INFO( "MAC address %x:%x:%x:%x:%x:%x:%x:%x", un_addr.u8[0],
+            un_addr.u8[1], un_addr.u8[2], un_addr.u8[3], un_addr.u8[4],
+            un_addr.u8[5], un_addr.u8[6], un_addr.u8[7] );
+
+    return 1;
+} /* _native_sim_init() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SIM transport message send
+ *  \param  pr_payload    Pointer to a payload.
+ *  \param  c_len         Length of a payload
+ *  \return int8_t        Status code.
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_sim_send( const void *pr_payload, uint8_t c_len )
+{
+    sim_hostRadioTx( pr_payload, c_len );
+
+    LOG_OK( "TX packet [%d]", c_len );
+    LOG2_HEXDUMP( pr_payload, c_len );
+    return RADIO_TX_OK;
+} /* _native_sim_send() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SIM transport wrapper function
+ *  \return 0
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_sim_on( void )
+{
+    return 0;
+} /* _native_sim_on() */
+
+/*----------------------------------------------------------------------------*/
+/** \brief  NATIVE_SIM transport wrapper function
+ *  \return 0
+ */
+/*----------------------------------------------------------------------------*/
+static int8_t _native_sim_off( void )
+{
+    return 0;
+} /* _native_sim_off() */
+
+/*==============================================================================
+ API FUNCTIONS
+ ==============================================================================*/
+/*----------------------------------------------------------------------------*/
+/*  sim_nodeInput()                                                           */
+/*----------------------------------------------------------------------------*/
+void sim_nodeInput( const uint8_t * pc_data, uint8_t c_len )
+{
+    if( ( p_lmac == NULL ) || ( c_len == 0 ) || ( c_len > PACKETBUF_SIZE ) )
+    {
+        LOG_ERR( "Failed to receive packet" );
+        return;
+    }
+
+    packetbuf_clear();
+    memcpy( packetbuf_dataptr(), pc_data, c_len );
+    packetbuf_set_datalen( c_len );
+    LOG_OK( "RX packet [%d]", c_len );
+    LOG2_HEXDUMP( packetbuf_dataptr(), c_len );
+    p_lmac->input();
+} /* sim_nodeInput() */
+/** @} */
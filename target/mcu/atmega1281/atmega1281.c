@@ -62,6 +62,7 @@
 #include "emb6.h"
 #include "board_conf.h"
 #include "avr/wdt.h"
+#include "avr/sleep.h"
 #include "math.h"
 #include "target.h"
 #include "hwinit.h"
@@ -491,6 +492,22 @@ void hal_delay_us( uint32_t i_delay )
     _hal_delay_loop( ( i_delay * 4 ) / 2 );
 } /* hal_delay_us() */
 
+/*==============================================================================
+ hal_waitUntil()
+ =============================================================================*/
+uint8_t hal_waitUntil( clock_time_t l_deadline, uint8_t c_wakeSrc )
+{
+    if( ( c_wakeSrc & HAL_WAKE_TIMER ) &&
+        ( (int32_t)( hal_getTick() - l_deadline ) >= 0 ) )
+        return HAL_WAKE_TIMER;
+
+    /* Idle mode keeps timer 0 running, so the tick interrupt or any other
+     * interrupt ends the sleep */
+    set_sleep_mode( SLEEP_MODE_IDLE );
+    sleep_mode();
+    return HAL_WAKE_IRQ;
+} /* hal_waitUntil() */
+
 /*==============================================================================
  hal_ctrlPinInit()
  =============================================================================*/
@@ -27,6 +27,15 @@
 /*==============================================================================
                                      MACROS
 ==============================================================================*/
+/** Clock source. If TRUE time is virtual: it advances only by
+    hal_delay_us() and by jumping to the deadline in hal_waitUntil(), so
+    timer driven scenarios run as fast as the stack handles its events.
+    Otherwise CLOCK_MONOTONIC is used. */
+#ifdef NATIVE_CONF_VIRTUAL_CLOCK
+#define NATIVE_VIRTUAL_CLOCK                NATIVE_CONF_VIRTUAL_CLOCK
+#else
+#define NATIVE_VIRTUAL_CLOCK                0
+#endif /* NATIVE_CONF_VIRTUAL_CLOCK */
 
 /*==============================================================================
                                      ENUMS
@@ -76,6 +85,24 @@
 ==============================================================================*/
 extern const uint8_t                         mac_address[8];
 
+/*==============================================================================
+                          FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/** \brief  Watch a file descriptor in \ref hal_waitUntil()
+ *
+ *          Whenever the descriptor becomes readable while the stack waits,
+ *          the callback is called from the main loop with a pointer to the
+ *          descriptor as parameter.
+ *
+ *  \param    i_fd            File descriptor to watch
+ *  \param    pfn_callback    Function to call when the descriptor is readable
+ *
+ *  \retval    1 on success, 0 otherwise
+ */
+/*============================================================================*/
+uint8_t hal_fdWatch(int i_fd, pfn_intCallb_t pfn_callback);
+
 #endif /* HWINIT_H_ */
 /** @} */
 /** @} */
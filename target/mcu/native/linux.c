@@ -82,6 +82,8 @@
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/signal.h>
+#include <sys/epoll.h>
+#include <errno.h>
 #include <stdlib.h>
 
 #include "logger.h"
@@ -92,10 +94,20 @@
 /*==============================================================================
                          STRUCTURES AND OTHER TYPEDEFS
 ==============================================================================*/
+/** Maximal amount of file descriptors watched by hal_waitUntil() */
+#define HAL_FD_WATCH_MAX                    4
+
+/** File descriptor watched by hal_waitUntil() */
+typedef struct
+{
+    int             i_fd;
+    pfn_intCallb_t  pfn_callback;
+} s_halFdWatch_t;
 
 /*==============================================================================
                            LOCAL FUNCTION PROTOTYPES
 ==============================================================================*/
+static uint8_t _hal_fdWait( int32_t l_timeout );
 #if DEMO_USE_EXTIF
 static void _printAndExit( const char* rpc_reason );
 static void signal_handler_IO (int status);
@@ -105,7 +117,13 @@ static void signal_handler_interrupt(int signum);
 /*==============================================================================
                           VARIABLE DECLARATIONS
 ==============================================================================*/
-static    struct timespec             tim = {0,0};
+#if NATIVE_VIRTUAL_CLOCK
+/** Virtual time in microseconds */
+static    uint64_t                    l_virtUs = 0;
+#endif /* NATIVE_VIRTUAL_CLOCK */
+static    int                         i_epollFd = -1;
+static    s_halFdWatch_t              as_fdWatch[HAL_FD_WATCH_MAX];
+static    uint8_t                     c_fdWatchCnt = 0;
 #if DEMO_USE_EXTIF
 static int fdm = -1;
 pfn_intCallb_t isr_rxCallb = NULL;
@@ -119,6 +137,30 @@ pfn_intCallb_t isr_rxCallb = NULL;
                                 LOCAL FUNCTIONS
 ==============================================================================*/
 
+/*==============================================================================
+  _hal_fdWait()
+ =============================================================================*/
+static uint8_t _hal_fdWait( int32_t l_timeout )
+{
+    struct epoll_event as_ev[HAL_FD_WATCH_MAX];
+    s_halFdWatch_t *ps_watch;
+    int i_cnt;
+    int i;
+
+    i_cnt = epoll_wait( i_epollFd, as_ev, HAL_FD_WATCH_MAX, l_timeout );
+    if( i_cnt < 0 )
+        return HAL_WAKE_IRQ;
+    if( i_cnt == 0 )
+        return HAL_WAKE_TIMER;
+
+    for( i = 0; i < i_cnt; i++ )
+    {
+        ps_watch = (s_halFdWatch_t *)as_ev[i].data.ptr;
+        ps_watch->pfn_callback( &ps_watch->i_fd );
+    }
+    return HAL_WAKE_FD;
+} /* _hal_fdWait() */
+
 #if DEMO_USE_EXTIF
 int putchar (int __c)
 {
@@ -197,10 +239,101 @@ uint8_t hal_extIntInit( en_targetExtInt_t e_intSource,
  =============================================================================*/
 void    hal_delay_us(uint32_t l_delay)
 {
-    tim.tv_nsec = l_delay*1000;
-    nanosleep(&tim, NULL);
+#if NATIVE_VIRTUAL_CLOCK
+    l_virtUs += l_delay;
+#else
+    struct timespec s_wait;
+
+    s_wait.tv_sec = l_delay / 1000000UL;
+    s_wait.tv_nsec = ( l_delay % 1000000UL ) * 1000L;
+    nanosleep( &s_wait, NULL );
+#endif /* NATIVE_VIRTUAL_CLOCK */
 } /* hal_delay_us() */
 
+/*==============================================================================
+  hal_waitUntil()
+ =============================================================================*/
+uint8_t hal_waitUntil(clock_time_t l_deadline, uint8_t c_wakeSrc)
+{
+    int32_t l_left = -1;
+    struct timespec s_wait;
+
+    if( c_wakeSrc & HAL_WAKE_TIMER )
+    {
+        l_left = (int32_t)( l_deadline - hal_getTick() );
+        if( l_left < 0 )
+            l_left = 0;
+    }
+
+#if NATIVE_VIRTUAL_CLOCK
+    if( l_left >= 0 )
+    {
+        /* Handle whatever is pending, then jump to the deadline at once */
+        if( ( c_wakeSrc & HAL_WAKE_FD ) && ( i_epollFd >= 0 ) )
+        {
+            uint8_t c_ret = _hal_fdWait( 0 );
+            if( c_ret != HAL_WAKE_TIMER )
+                return c_ret;
+        }
+        l_virtUs += (uint64_t)l_left * 1000;
+        return HAL_WAKE_TIMER;
+    }
+    /* Without a timer there is nothing to skip, wait in real time */
+#endif /* NATIVE_VIRTUAL_CLOCK */
+
+    if( ( c_wakeSrc & HAL_WAKE_FD ) && ( i_epollFd >= 0 ) )
+        return _hal_fdWait( l_left );
+
+    if( l_left < 0 )
+    {
+        /* Only a signal can wake us up */
+        pause();
+        return HAL_WAKE_IRQ;
+    }
+
+    if( l_left == 0 )
+        return HAL_WAKE_TIMER;
+
+    s_wait.tv_sec = l_left / 1000;
+    s_wait.tv_nsec = ( l_left % 1000 ) * 1000000L;
+    /* nanosleep() is interrupted by a signal handler, e.g. SIGIO */
+    if( nanosleep( &s_wait, NULL ) != 0 )
+        return HAL_WAKE_IRQ;
+    return HAL_WAKE_TIMER;
+} /* hal_waitUntil() */
+
+/*==============================================================================
+  hal_fdWatch()
+ =============================================================================*/
+uint8_t hal_fdWatch(int i_fd, pfn_intCallb_t pfn_callback)
+{
+    struct epoll_event s_ev;
+    s_halFdWatch_t *ps_watch;
+
+    if( ( pfn_callback == NULL ) || ( c_fdWatchCnt == HAL_FD_WATCH_MAX ) )
+        return 0;
+
+    if( i_epollFd < 0 )
+    {
+        i_epollFd = epoll_create1( 0 );
+        if( i_epollFd < 0 )
+            return 0;
+    }
+
+    ps_watch = &as_fdWatch[c_fdWatchCnt];
+    ps_watch->i_fd = i_fd;
+    ps_watch->pfn_callback = pfn_callback;
+
+    memset( &s_ev, 0, sizeof( s_ev ) );
+    s_ev.events = EPOLLIN;
+    s_ev.data.ptr = ps_watch;
+    if( epoll_ctl( i_epollFd, EPOLL_CTL_ADD, i_fd, &s_ev ) != 0 )
+        return 0;
+
+    c_fdWatchCnt++;
+    return 1;
+} /* hal_fdWatch() */
+
 
 void hal_enterCritical(void){}
 void hal_exitCritical(void){};
@@ -273,11 +406,15 @@ clock_time_t hal_getTRes(void)
  =============================================================================*/
 uint32_t     hal_getTick(void)
 {
-      struct timeval tv;
+#if NATIVE_VIRTUAL_CLOCK
+      return (uint32_t)( l_virtUs / 1000 );
+#else
+      struct timespec ts;
 
-      gettimeofday(&tv, NULL);
+      clock_gettime(CLOCK_MONOTONIC, &ts);
 
-      return ((tv.tv_sec * 1000 + tv.tv_usec / 1000) & 0xffffffff);
+      return ((ts.tv_sec * 1000 + ts.tv_nsec / 1000000) & 0xffffffff);
+#endif /* NATIVE_VIRTUAL_CLOCK */
 } /* hal_getTick() */
 
 /*==============================================================================
@@ -285,11 +422,15 @@ uint32_t     hal_getTick(void)
  =============================================================================*/
 uint32_t     hal_getSec(void)
 {
-      struct timeval tv;
+#if NATIVE_VIRTUAL_CLOCK
+      return (uint32_t)( l_virtUs / 1000000 );
+#else
+      struct timespec ts;
 
-      gettimeofday(&tv, NULL);
+      clock_gettime(CLOCK_MONOTONIC, &ts);
 
-      return tv.tv_sec;
+      return ts.tv_sec;
+#endif /* NATIVE_VIRTUAL_CLOCK */
 } /* hal_getSec() */
 /** @} */
 /** @} */
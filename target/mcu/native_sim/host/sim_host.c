@@ -0,0 +1,529 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup native_sim_hal
+ * @{
+ */
+/*! \file   native_sim/host/sim_host.c
+
+    \brief  Discrete event simulator running many emb6 nodes in one process.
+
+            The stack is loaded once as shared object. Every node owns a
+            copy of its writable segment, which is swapped in before the
+            node runs, see sim.h. Nodes are driven by a queue of events
+            ordered by virtual time: either a timer of a node expires or a
+            frame arrives at a node. Virtual time jumps from one event to
+            the next, hence the simulation runs as fast as the nodes are
+            able to handle their events.
+
+            The topology is read from a file in the format of
+            lcmnetwork.conf. Usage:
+
+            emb6sim [-c topology] [-t seconds] [-r root] node.so
+
+   \version 0.1
+*/
+/*============================================================================*/
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define     _GNU_SOURCE
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <link.h>
+#include "../sim.h"
+
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+/** Default topology file */
+#define SIM_TOPOLOGY                        "lcmnetwork.conf"
+
+/** Default duration of a simulation in seconds */
+#define SIM_DURATION                        60
+
+/** Time a frame needs to reach the listeners in ticks */
+#define SIM_RADIO_DELAY                     1
+
+/** Maximal length of a line of the topology file */
+#define SIM_LINE_MAX                        2048
+
+/*==============================================================================
+                         STRUCTURES AND OTHER TYPEDEFS
+==============================================================================*/
+/** Frame on its way to the listeners, shared between their events */
+typedef struct
+{
+    uint32_t l_ref;
+    uint8_t  c_len;
+    uint8_t  ac_data[];
+} s_simFrame_t;
+
+/** Simulated node */
+typedef struct
+{
+    uint16_t i_addr;
+    /** Indices of the nodes hearing this node */
+    uint16_t *pi_dst;
+    uint16_t i_dstCnt;
+    /** Writable segment of the stack belonging to this node */
+    uint8_t *pc_ctx;
+    /** Time and generation of the valid wake up event */
+    uint64_t ll_wake;
+    uint32_t l_wakeGen;
+    uint8_t  c_wakeSet;
+    uint32_t l_tx;
+    uint32_t l_rx;
+} s_simNode_t;
+
+/** Event of the simulation, either a wake up or a frame reception */
+typedef struct
+{
+    uint64_t ll_time;
+    /** Events of the same time are handled in order of creation */
+    uint32_t l_seq;
+    uint32_t l_gen;
+    uint16_t i_node;
+    s_simFrame_t *ps_frame;
+} s_simEvent_t;
+
+typedef uint8_t (*pfn_simNodeInit_t)(uint8_t c_root);
+typedef uint8_t (*pfn_simNodeRun_t)(uint32_t * pl_deadline);
+typedef void (*pfn_simNodeInput_t)(const uint8_t * pc_data, uint8_t c_len);
+
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+static uint64_t ll_simNow;
+static s_simNode_t *ps_simNodes;
+static uint16_t i_simNodeCnt;
+static s_simNode_t *ps_simCur;
+
+/* Event queue as binary min heap */
+static s_simEvent_t *ps_simHeap;
+static uint32_t l_simHeapCnt;
+static uint32_t l_simHeapMax;
+static uint32_t l_simSeq;
+
+/* Writable segment of the loaded stack */
+static uint8_t *pc_simSeg;
+static size_t l_simSegLen;
+static const char *pc_simLib;
+
+static pfn_simNodeInit_t pfn_simNodeInit;
+static pfn_simNodeRun_t pfn_simNodeRun;
+static pfn_simNodeInput_t pfn_simNodeInput;
+
+/*==============================================================================
+                                LOCAL FUNCTIONS
+==============================================================================*/
+static void _sim_exit(const char * pc_reason)
+{
+    fprintf(stderr, "emb6sim: %s\n", pc_reason);
+    exit(1);
+}
+
+static void * _sim_alloc(size_t l_size)
+{
+    void *p_mem = calloc(1, l_size);
+    if (p_mem == NULL)
+        _sim_exit("out of memory");
+    return p_mem;
+}
+
+static int _sim_before(const s_simEvent_t * ps_a, const s_simEvent_t * ps_b)
+{
+    if (ps_a->ll_time != ps_b->ll_time)
+        return ps_a->ll_time < ps_b->ll_time;
+    return (int32_t)(ps_a->l_seq - ps_b->l_seq) < 0;
+}
+
+static void _sim_push(uint64_t ll_time, uint16_t i_node, uint32_t l_gen,
+        s_simFrame_t * ps_frame)
+{
+    s_simEvent_t s_ev;
+    uint32_t l_idx;
+
+    if (l_simHeapCnt == l_simHeapMax) {
+        l_simHeapMax = l_simHeapMax ? l_simHeapMax * 2 : 256;
+        ps_simHeap = realloc(ps_simHeap, l_simHeapMax * sizeof(s_simEvent_t));
+        if (ps_simHeap == NULL)
+            _sim_exit("out of memory");
+    }
+
+    s_ev.ll_time = ll_time;
+    s_ev.l_seq = l_simSeq++;
+    s_ev.l_gen = l_gen;
+    s_ev.i_node = i_node;
+    s_ev.ps_frame = ps_frame;
+
+    l_idx = l_simHeapCnt++;
+    while (l_idx > 0 && _sim_before(&s_ev, &ps_simHeap[(l_idx - 1) / 2])) {
+        ps_simHeap[l_idx] = ps_simHeap[(l_idx - 1) / 2];
+        l_idx = (l_idx - 1) / 2;
+    }
+    ps_simHeap[l_idx] = s_ev;
+}
+
+static void _sim_pop(s_simEvent_t * ps_ev)
+{
+    s_simEvent_t s_last;
+    uint32_t l_idx = 0;
+    uint32_t l_child;
+
+    *ps_ev = ps_simHeap[0];
+    s_last = ps_simHeap[--l_simHeapCnt];
+    while ((l_child = 2 * l_idx + 1) < l_simHeapCnt) {
+        if ((l_child + 1 < l_simHeapCnt) &&
+            _sim_before(&ps_simHeap[l_child + 1], &ps_simHeap[l_child]))
+            l_child++;
+        if (!_sim_before(&ps_simHeap[l_child], &s_last))
+            break;
+        ps_simHeap[l_idx] = ps_simHeap[l_child];
+        l_idx = l_child;
+    }
+    ps_simHeap[l_idx] = s_last;
+}
+
+static int _sim_findNode(uint16_t i_addr)
+{
+    uint16_t i;
+
+    for (i = 0; i < i_simNodeCnt; i++) {
+        if (ps_simNodes[i].i_addr == i_addr)
+            return i;
+    }
+    return -1;
+}
+
+static int _sim_findSeg(struct dl_phdr_info * ps_info, size_t l_size,
+        void * p_base)
+{
+    uintptr_t l_start = 0, l_end = 0, l_relro = 0;
+    int i;
+
+    if (ps_info->dlpi_addr != (uintptr_t)p_base)
+        return 0;
+
+    for (i = 0; i < ps_info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *ps_ph = &ps_info->dlpi_phdr[i];
+        if ((ps_ph->p_type == PT_LOAD) && (ps_ph->p_flags & PF_W)) {
+            if (l_end != 0)
+                _sim_exit("more than one writable segment");
+            l_start = ps_info->dlpi_addr + ps_ph->p_vaddr;
+            l_end = l_start + ps_ph->p_memsz;
+        }
+        else if (ps_ph->p_type == PT_GNU_RELRO) {
+            l_relro = ps_info->dlpi_addr + ps_ph->p_vaddr + ps_ph->p_memsz;
+        }
+    }
+
+    /* The read only part after relocation is the same for every node */
+    if (l_relro > l_start)
+        l_start = l_relro;
+    if (l_start >= l_end)
+        _sim_exit("no writable segment");
+
+    pc_simSeg = (uint8_t *)l_start;
+    l_simSegLen = l_end - l_start;
+    return 1;
+}
+
+static void _sim_load(void)
+{
+    struct link_map *ps_map;
+    void *p_lib;
+
+    /* Lazy binding, because the stack references HAL functions of real
+     * hardware which are never called in the simulation */
+    p_lib = dlopen(pc_simLib, RTLD_LAZY | RTLD_LOCAL);
+    if (p_lib == NULL)
+        _sim_exit(dlerror());
+
+    pfn_simNodeInit = (pfn_simNodeInit_t)dlsym(p_lib, SIM_NODE_INIT);
+    pfn_simNodeRun = (pfn_simNodeRun_t)dlsym(p_lib, SIM_NODE_RUN);
+    pfn_simNodeInput = (pfn_simNodeInput_t)dlsym(p_lib, SIM_NODE_INPUT);
+    if (!pfn_simNodeInit || !pfn_simNodeRun || !pfn_simNodeInput)
+        _sim_exit("not a simulation build of emb6");
+
+    if (dlinfo(p_lib, RTLD_DI_LINKMAP, &ps_map) != 0)
+        _sim_exit(dlerror());
+    if (!dl_iterate_phdr(_sim_findSeg, (void *)ps_map->l_addr))
+        _sim_exit("segment of the stack not found");
+}
+
+static void _sim_readTopology(const char * pc_file)
+{
+    char ac_line[SIM_LINE_MAX];
+    char *pc_tok;
+    uint16_t i_addr;
+    uint16_t i_max = 0;
+    FILE *fp;
+    int i_pass;
+    int i_dst;
+    s_simNode_t *ps_node;
+
+    fp = fopen(pc_file, "r");
+    if (fp == NULL)
+        _sim_exit("can't open topology file");
+
+    /* First pass collects the nodes, second one their listeners */
+    for (i_pass = 0; i_pass < 2; i_pass++) {
+        rewind(fp);
+        while (fgets(ac_line, sizeof(ac_line), fp) != NULL) {
+            if (ac_line[0] == '#')
+                continue;
+            pc_tok = strtok(ac_line, " \t\r\n,");
+            if ((pc_tok == NULL) || (sscanf(pc_tok, "%hx", &i_addr) != 1))
+                continue;
+
+            if (i_pass == 0) {
+                if (_sim_findNode(i_addr) >= 0)
+                    continue;
+                if (i_simNodeCnt == i_max) {
+                    i_max = i_max ? i_max * 2 : 64;
+                    ps_simNodes = realloc(ps_simNodes,
+                            i_max * sizeof(s_simNode_t));
+                    if (ps_simNodes == NULL)
+                        _sim_exit("out of memory");
+                }
+                memset(&ps_simNodes[i_simNodeCnt], 0, sizeof(s_simNode_t));
+                ps_simNodes[i_simNodeCnt++].i_addr = i_addr;
+                continue;
+            }
+
+            ps_node = &ps_simNodes[_sim_findNode(i_addr)];
+            while ((pc_tok = strtok(NULL, " \t\r\n,")) != NULL) {
+                if ((sscanf(pc_tok, "%hx", &i_addr) != 1) ||
+                    ((i_dst = _sim_findNode(i_addr)) < 0))
+                    continue;
+                ps_node->pi_dst = realloc(ps_node->pi_dst,
+                        (ps_node->i_dstCnt + 1) * sizeof(uint16_t));
+                if (ps_node->pi_dst == NULL)
+                    _sim_exit("out of memory");
+                ps_node->pi_dst[ps_node->i_dstCnt++] = (uint16_t)i_dst;
+            }
+        }
+    }
+    fclose(fp);
+
+    if (i_simNodeCnt == 0)
+        _sim_exit("no nodes in topology file");
+}
+
+static void _sim_swap(s_simNode_t * ps_node)
+{
+    if (ps_simCur == ps_node)
+        return;
+    if (ps_simCur != NULL)
+        memcpy(ps_simCur->pc_ctx, pc_simSeg, l_simSegLen);
+    memcpy(pc_simSeg, ps_node->pc_ctx, l_simSegLen);
+    ps_simCur = ps_node;
+}
+
+static void _sim_run(s_simNode_t * ps_node)
+{
+    uint32_t l_deadline;
+    int32_t l_left;
+    uint64_t ll_wake;
+
+    if (!pfn_simNodeRun(&l_deadline)) {
+        /* Waiting for frames only, a pending wake up becomes invalid */
+        ps_node->c_wakeSet = 0;
+        ps_node->l_wakeGen++;
+        return;
+    }
+
+    l_left = (int32_t)(l_deadline - (uint32_t)ll_simNow);
+    ll_wake = ll_simNow + (l_left > 0 ? l_left : 1);
+    if (ps_node->c_wakeSet && (ps_node->ll_wake == ll_wake))
+        return;
+
+    ps_node->ll_wake = ll_wake;
+    ps_node->c_wakeSet = 1;
+    ps_node->l_wakeGen++;
+    _sim_push(ll_wake, ps_node - ps_simNodes, ps_node->l_wakeGen, NULL);
+}
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+uint32_t sim_hostGetTick(void)
+{
+    return (uint32_t)ll_simNow;
+}
+
+uint16_t sim_hostNodeAddr(void)
+{
+    return ps_simCur->i_addr;
+}
+
+void sim_hostRadioTx(const uint8_t * pc_data, uint8_t c_len)
+{
+    s_simFrame_t *ps_frame;
+    uint16_t i;
+
+    ps_simCur->l_tx++;
+    if (ps_simCur->i_dstCnt == 0)
+        return;
+
+    ps_frame = _sim_alloc(sizeof(s_simFrame_t) + c_len);
+    ps_frame->l_ref = ps_simCur->i_dstCnt;
+    ps_frame->c_len = c_len;
+    memcpy(ps_frame->ac_data, pc_data, c_len);
+
+    for (i = 0; i < ps_simCur->i_dstCnt; i++) {
+        _sim_push(ll_simNow + SIM_RADIO_DELAY, ps_simCur->pi_dst[i], 0,
+                ps_frame);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    const char *pc_topology = SIM_TOPOLOGY;
+    uint64_t ll_end = SIM_DURATION * 1000ULL;
+    uint64_t ll_events = 0;
+    int i_root = -1;
+    uint16_t i_addr;
+    uint8_t *pc_init;
+    s_simEvent_t s_ev;
+    s_simNode_t *ps_node;
+    struct timespec s_start, s_stop;
+    double d_wall;
+    int i_opt;
+    uint16_t i;
+
+    while ((i_opt = getopt(argc, argv, "c:t:r:")) != -1) {
+        switch (i_opt) {
+            case 'c':
+                pc_topology = optarg;
+                break;
+            case 't':
+                ll_end = strtoull(optarg, NULL, 0) * 1000ULL;
+                break;
+            case 'r':
+                i_root = (int)strtoul(optarg, NULL, 16);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-c topology] [-t seconds] "
+                        "[-r root] node.so\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc)
+        _sim_exit("no stack given");
+    pc_simLib = argv[optind];
+
+    _sim_readTopology(pc_topology);
+    _sim_load();
+
+    if (i_root < 0)
+        i_root = ps_simNodes[0].i_addr;
+
+    fprintf(stderr, "emb6sim: %u nodes, context %lu bytes per node\n",
+            i_simNodeCnt, (unsigned long)l_simSegLen);
+
+    /* Every node starts from the state right after loading */
+    pc_init = _sim_alloc(l_simSegLen);
+    memcpy(pc_init, pc_simSeg, l_simSegLen);
+
+    clock_gettime(CLOCK_MONOTONIC, &s_start);
+    for (i = 0; i < i_simNodeCnt; i++) {
+        ps_node = &ps_simNodes[i];
+        ps_node->pc_ctx = _sim_alloc(l_simSegLen);
+        memcpy(ps_node->pc_ctx, pc_init, l_simSegLen);
+
+        _sim_swap(ps_node);
+        i_addr = ps_node->i_addr;
+        if (!pfn_simNodeInit(i_addr == (uint16_t)i_root))
+            _sim_exit("node initialization failed");
+        _sim_run(ps_node);
+    }
+    free(pc_init);
+
+    while (l_simHeapCnt > 0) {
+        _sim_pop(&s_ev);
+        if (s_ev.ll_time > ll_end)
+            break;
+
+        ps_node = &ps_simNodes[s_ev.i_node];
+        if (s_ev.ps_frame == NULL) {
+            /* Drop wake ups which were superseded */
+            if (!ps_node->c_wakeSet || (s_ev.l_gen != ps_node->l_wakeGen))
+                continue;
+            ps_node->c_wakeSet = 0;
+        }
+
+        ll_simNow = s_ev.ll_time;
+        ll_events++;
+        _sim_swap(ps_node);
+
+        if (s_ev.ps_frame != NULL) {
+            ps_node->l_rx++;
+            pfn_simNodeInput(s_ev.ps_frame->ac_data, s_ev.ps_frame->c_len);
+            if (--s_ev.ps_frame->l_ref == 0)
+                free(s_ev.ps_frame);
+        }
+        _sim_run(ps_node);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &s_stop);
+
+    d_wall = (s_stop.tv_sec - s_start.tv_sec) +
+             (s_stop.tv_nsec - s_start.tv_nsec) / 1e9;
+    fprintf(stderr, "emb6sim: %.3f s simulated in %.3f s, %llu events\n",
+            ll_simNow / 1000.0, d_wall, (unsigned long long)ll_events);
+    for (i = 0; i < i_simNodeCnt; i++) {
+        fprintf(stderr, "emb6sim: node 0x%04X tx %u rx %u\n",
+                ps_simNodes[i].i_addr, ps_simNodes[i].l_tx,
+                ps_simNodes[i].l_rx);
+    }
+    return 0;
+}
+/** @} */
@@ -0,0 +1,134 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \addtogroup native_sim_hal
+ * @{
+ */
+/*============================================================================*/
+/*! \file   native_sim/sim.h
+
+    \brief  Interface between the emb6 simulator and the simulated nodes.
+
+            The stack is built as a shared object and loaded once by the
+            simulator host. The writable segment of the shared object holds
+            every global and static variable of the stack and therefore is
+            the context of a node. The host keeps one copy of this segment
+            per node and swaps it in before a node runs and out afterwards.
+
+            A node calls the host through the sim_host* functions, which are
+            exported by the simulator executable. The host calls a node
+            through the sim_node* functions, which it resolves in the shared
+            object.
+
+   \version 0.1
+*/
+/*============================================================================*/
+#ifndef SIM_H_
+#define SIM_H_
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdint.h>
+
+/*==============================================================================
+                          FUNCTION PROTOTYPES
+==============================================================================*/
+/*============================================================================*/
+/** \brief  Virtual time of the simulation
+ *
+ *  \return Milliseconds since the start of the simulation
+ */
+/*============================================================================*/
+uint32_t sim_hostGetTick(void);
+
+/*============================================================================*/
+/** \brief  Address of the node which is running
+ *
+ *  \return Last two bytes of the MAC address of the node
+ */
+/*============================================================================*/
+uint16_t sim_hostNodeAddr(void);
+
+/*============================================================================*/
+/** \brief  Transmit a frame to every node which can hear the running node
+ *
+ *  \param  pc_data     Frame to transmit
+ *  \param  c_len       Length of the frame
+ */
+/*============================================================================*/
+void sim_hostRadioTx(const uint8_t * pc_data, uint8_t c_len);
+
+/*============================================================================*/
+/** \brief  Initialize the node which is swapped in
+ *
+ *  \param  c_root      Start a RPL DODAG with this node as root
+ *
+ *  \return 1 on success, 0 otherwise
+ */
+/*============================================================================*/
+uint8_t sim_nodeInit(uint8_t c_root);
+
+/*============================================================================*/
+/** \brief  Handle every pending event of the node which is swapped in
+ *
+ *  \param  pl_deadline Set to the tick at which the node wants to run again
+ *
+ *  \return 1 if pl_deadline was set, 0 if the node waits for frames only
+ */
+/*============================================================================*/
+uint8_t sim_nodeRun(uint32_t * pl_deadline);
+
+/*============================================================================*/
+/** \brief  Pass a received frame to the node which is swapped in
+ *
+ *  \param  pc_data     Received frame
+ *  \param  c_len       Length of the frame
+ */
+/*============================================================================*/
+void sim_nodeInput(const uint8_t * pc_data, uint8_t c_len);
+
+/** Names of the node functions resolved by the host */
+#define SIM_NODE_INIT                       "sim_nodeInit"
+#define SIM_NODE_RUN                        "sim_nodeRun"
+#define SIM_NODE_INPUT                      "sim_nodeInput"
+
+#endif /* SIM_H_ */
+/** @} */
@@ -0,0 +1,158 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*============================================================================*/
+/**
+ * \addtogroup bsp
+ * @{
+ * \addtogroup mcu MCU HAL library
+ * @{
+ */
+/**
+ * \addtogroup native_sim_hal
+ * @{
+ *
+ * HAL of a node which runs inside of the emb6 simulator.
+ *
+ */
+/*! \file   native_sim/sim_hal.c
+
+    \brief  HAL of a node which runs inside of the emb6 simulator.
+
+            Time is the virtual time of the simulator and does not advance
+            while a node runs. Every variable of this file is part of the
+            node context which is swapped by the simulator.
+
+   \version 0.1
+*/
+/*============================================================================*/
+/*==============================================================================
+                                     MACROS
+==============================================================================*/
+#define     LOGGER_ENABLE        LOGGER_HAL
+
+/*==============================================================================
+                                 INCLUDE FILES
+==============================================================================*/
+#include <stdio.h>
+#include "target.h"
+#include "hwinit.h"
+#include "sim.h"
+
+#include "logger.h"
+/*==============================================================================
+                          VARIABLE DECLARATIONS
+==============================================================================*/
+/** State of the random generator of the node */
+static    uint32_t                    l_simRand;
+
+/*==============================================================================
+                                 API FUNCTIONS
+==============================================================================*/
+
+/*==============================================================================
+ hal_extIntInit()
+ =============================================================================*/
+uint8_t hal_extIntInit( en_targetExtInt_t e_intSource,
+        pfn_intCallb_t pfn_intCallback )
+{
+    /* Frames are passed to the radio driver by the simulator */
+    return 0;
+} /* hal_extIntInit() */
+
+/*==============================================================================
+  hal_delay_us()
+ =============================================================================*/
+void    hal_delay_us(uint32_t l_delay)
+{
+    /* Virtual time can't advance while a node runs */
+} /* hal_delay_us() */
+
+/*==============================================================================
+  hal_waitUntil()
+ =============================================================================*/
+uint8_t hal_waitUntil(clock_time_t l_deadline, uint8_t c_wakeSrc)
+{
+    /* The simulator itself waits for the deadline, see sim_nodeRun() */
+    return 0;
+} /* hal_waitUntil() */
+
+void hal_enterCritical(void){}
+void hal_exitCritical(void){}
+void hal_ledOff(uint16_t ui_led){}
+void hal_ledOn(uint16_t ui_led){}
+int8_t hal_init (void)
+{
+    /* Every node gets a reproducible random sequence of its own */
+    l_simRand = 0x2545F491UL ^ sim_hostNodeAddr();
+    return 1;
+}
+void hal_watchdogReset(void){}
+void hal_watchdogStart(void){}
+void hal_watchdogStop(void){}
+
+
+uint8_t    hal_getrand(void)
+{
+    l_simRand = l_simRand * 1103515245UL + 12345UL;
+    return ((uint8_t)(l_simRand >> 16));
+}
+
+clock_time_t hal_getTRes(void)
+{
+    return CLOCK_SECOND;
+}
+/*==============================================================================
+  hal_getTick()
+ =============================================================================*/
+clock_time_t hal_getTick(void)
+{
+    return sim_hostGetTick();
+} /* hal_getTick() */
+
+/*==============================================================================
+  hal_getSec()
+ =============================================================================*/
+clock_time_t hal_getSec(void)
+{
+    return sim_hostGetTick() / CLOCK_SECOND;
+} /* hal_getSec() */
+/** @} */
+/** @} */
+/** @} */
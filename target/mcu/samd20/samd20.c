@@ -449,6 +449,20 @@ void hal_delay_us( uint32_t i_delay )
     delay_us( i_delay );
 } /* hal_delay_us() */
 
+/*==============================================================================
+ hal_waitUntil()
+ =============================================================================*/
+uint8_t hal_waitUntil( clock_time_t l_deadline, uint8_t c_wakeSrc )
+{
+    if( ( c_wakeSrc & HAL_WAKE_TIMER ) &&
+        ( (int32_t)( hal_getTick() - l_deadline ) >= 0 ) )
+        return HAL_WAKE_TIMER;
+
+    /* Any interrupt, including the tick timer, ends the sleep */
+    __WFI();
+    return HAL_WAKE_IRQ;
+} /* hal_waitUntil() */
+
 uint8_t hal_gpioPinInit( uint8_t c_pin, uint8_t c_dir, uint8_t c_initState )
 {
     struct port_config pin_conf;
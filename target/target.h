@@ -56,6 +56,11 @@
 
 #include "emb6.h"
 
+/** Wake up sources of \ref hal_waitUntil() */
+#define HAL_WAKE_TIMER        0x01    ///< Deadline has been reached
+#define HAL_WAKE_IRQ          0x02    ///< An interrupt or signal occurred
+#define HAL_WAKE_FD           0x04    ///< A watched file descriptor is readable
+
 typedef enum E_TARGET_EXTINT {
     E_TARGET_RADIO_INT,
     E_TARGET_USART_INT
@@ -283,6 +288,22 @@ clock_time_t     hal_getSec(void);
  */
 /*============================================================================*/
 clock_time_t hal_getTRes(void);
+
+/*============================================================================*/
+/** \brief  This function puts the MCU into an idle state until one of the
+ *          given wake up sources occurs
+ *
+ *          The function may return earlier than requested, e.g. on any
+ *          interrupt. The caller has to check for pending work again.
+ *
+ *  \param    l_deadline    Tick value to wake up at. Only used if
+ *                          \ref HAL_WAKE_TIMER is set in c_wakeSrc
+ *  \param    c_wakeSrc     Mask of HAL_WAKE_x sources allowed to end the wait
+ *
+ *  \retval    Source which ended the wait
+ */
+/*============================================================================*/
+uint8_t hal_waitUntil(clock_time_t l_deadline, uint8_t c_wakeSrc);
 #endif /* TARGET_H_ */
 /** @} */
 /** @} */
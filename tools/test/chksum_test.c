@@ -0,0 +1,167 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         Checksum test: compares uip_arch_chksum() of a target with the
+ *         generic byte-pair loop of uip6.c for random contents, lengths,
+ *         start alignments and start sums, and times both for common
+ *         payload sizes.
+ *
+ *         Built for each variant of the native routine and for the
+ *         Cortex-M routine, which is plain C and runs on the host.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "uip_arch.h"
+#include "test.h"
+
+static const int bench_sizes[] = { 16, 64, 128, 512, 1280 };
+
+#define BENCH_BYTES     (64UL * 1024 * 1024)
+#define FUZZ_RUNS       200000
+#define FUZZ_MAX_LEN    1300
+#define FUZZ_MAX_OFF    16
+
+static uint8_t buf[FUZZ_MAX_LEN + FUZZ_MAX_OFF] __attribute__((aligned(32)));
+
+/*---------------------------------------------------------------------------*/
+/* the generic chksum() of uip6.c */
+static uint16_t
+ref_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while(dataptr < last_byte) {
+    t = (dataptr[0] << 8) + dataptr[1];
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+    dataptr += 2;
+  }
+
+  if(dataptr == last_byte) {
+    t = (dataptr[0] << 8) + 0;
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fuzz(void)
+{
+  int i, k, off, len;
+  uint16_t sum, expected, got;
+  int mismatches = 0;
+
+  srand(1);
+  for(i = 0; i < FUZZ_RUNS; i++) {
+    off = rand() % FUZZ_MAX_OFF;
+    len = rand() % FUZZ_MAX_LEN;
+    /* all ones buffers and sums exercise the carries */
+    for(k = 0; k < sizeof(buf); k++) {
+      buf[k] = i % 7 == 0 ? 0xff : rand();
+    }
+    sum = i % 11 == 0 ? 0xffff : i % 13 == 0 ? 0 : rand();
+
+    expected = ref_chksum(sum, buf + off, len);
+    got = uip_arch_chksum(sum, buf + off, len);
+    if(got != expected && mismatches++ < 5) {
+      printf("offset %d length %d sum %04x: %04x, expected %04x\n",
+             off, len, sum, got, expected);
+    }
+  }
+  TEST_CHECK(mismatches == 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(void)
+{
+  unsigned long i, runs;
+  unsigned k;
+  volatile uint16_t sink = 0;
+  double start, ref_ns, arch_ns;
+
+  for(k = 0; k < sizeof(buf); k++) {
+    buf[k] = rand();
+  }
+  for(k = 0; k < sizeof(bench_sizes) / sizeof(bench_sizes[0]); k++) {
+    runs = BENCH_BYTES / bench_sizes[k];
+
+    start = test_now_ns();
+    for(i = 0; i < runs; i++) {
+      sink += ref_chksum(i, buf, bench_sizes[k]);
+    }
+    ref_ns = (test_now_ns() - start) / runs;
+
+    start = test_now_ns();
+    for(i = 0; i < runs; i++) {
+      sink += uip_arch_chksum(i, buf, bench_sizes[k]);
+    }
+    arch_ns = (test_now_ns() - start) / runs;
+
+    printf("%5d bytes: generic %7.1f ns, target %6.1f ns\n",
+           bench_sizes[k], ref_ns, arch_ns);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+#if defined(__AVX2__)
+  if(!__builtin_cpu_supports("avx2")) {
+    printf("no AVX2 on this host, skipped\n");
+    return 0;
+  }
+#endif
+  fuzz();
+  bench();
+
+  return TEST_RESULT();
+}
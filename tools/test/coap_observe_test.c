@@ -0,0 +1,304 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         CoAP notification test: the notifications, which are rendered
+ *         once and completed per observer from notification_split() and
+ *         notification_head(), must be the messages a serialization per
+ *         observer gives. Checked with and without ETag, for error codes,
+ *         for token and Observe option lengths, for confirmable
+ *         notifications sharing their end and for their retransmission.
+ *
+ *         The observe layer is included so the static functions can be
+ *         called. Messages are taken where er-coap.c hands them to UDP.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "er-coap-observe.c"
+#include "er-coap-engine.h"
+#include "udp-socket.h"
+#include "test.h"
+
+#define ROUNDS          45
+
+/* a sent message */
+struct message {
+  uint16_t len;
+  uint8_t buf[COAP_MAX_PACKET_SIZE + 1];
+};
+
+static struct message sent[COAP_MAX_OBSERVERS + 1];
+static int sent_count;
+static int renders;
+
+/* how the resource answers */
+static unsigned int res_code;
+static int res_etag;
+
+/* the transport and the timers are not tested */
+uip_buf_t uip_aligned_buf;
+uint8_t uip_ext_len;
+static struct uip_udp_conn udp_conn;
+
+int
+udp_socket_register(struct udp_socket *c, void *ptr,
+                    udp_socket_input_callback_t receive_callback)
+{
+  c->udp_conn = &udp_conn;
+  return 1;
+}
+
+int udp_socket_bind(struct udp_socket *c, uint16_t local_port) { return 1; }
+
+int
+udp_socket_connect(struct udp_socket *c, uip_ipaddr_t *remote_addr,
+                   uint16_t remote_port)
+{
+  return 1;
+}
+
+int
+udp_socket_send(struct udp_socket *c, const void *data, uint16_t datalen)
+{
+  if(sent_count < COAP_MAX_OBSERVERS + 1) {
+    memcpy(sent[sent_count].buf, data, datalen);
+    sent[sent_count].len = datalen;
+  }
+  sent_count++;
+  return datalen;
+}
+
+uint32_t bsp_get(en_bspParams_t param) { return 1000; }
+unsigned short random_rand(void) { return 7; }
+void coap_engine_callback(c_event_t c_event, p_data_t p_data) {}
+
+void
+etimer_set(struct etimer *et, clock_time_t interval, pfn_callback_t func)
+{
+  et->timer.interval = interval;
+  et->active = TMR_ACTIVE;
+}
+
+void etimer_stop(struct etimer *et) { et->active = TMR_NOT_ACTIVE; }
+int etimer_expired(struct etimer *et) { return et->active == TMR_NOT_ACTIVE; }
+
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(void *request, void *response, uint8_t *buffer,
+                uint16_t preferred_size, int32_t *offset)
+{
+  renders++;
+  coap_set_status_code(response, res_code);
+  coap_set_header_content_format(response, APPLICATION_JSON);
+  coap_set_header_max_age(response, 30);
+  if(res_etag) {
+    coap_set_header_etag(response, (uint8_t *)"\x01\x02\x03", 3);
+  }
+  coap_set_payload(response, buffer,
+                   sprintf((char *)buffer, "{\"t\":%d}", renders));
+}
+RESOURCE(res_obs, "", res_get_handler, NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+/* the notification as it was serialized for each observer on its own */
+static uint16_t
+reference(coap_observer_t *obs, int32_t counter, coap_message_type_t type,
+          uint16_t mid, uint8_t *out)
+{
+  static uint8_t buffer[REST_MAX_CHUNK_SIZE + 1];
+  coap_packet_t notification[1];
+
+  coap_init_message(notification, type, CONTENT_2_05, mid);
+  /* render the same representation again */
+  renders--;
+  res_get_handler(NULL, notification, buffer, REST_MAX_CHUNK_SIZE, NULL);
+  if(notification->code < BAD_REQUEST_4_00) {
+    coap_set_header_observe(notification, counter);
+  }
+  coap_set_token(notification, obs->token, obs->token_len);
+  return coap_serialize_message(notification, out);
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_message(const struct message *m, coap_observer_t *obs, int32_t counter,
+              coap_message_type_t type)
+{
+  static uint8_t expected[COAP_MAX_PACKET_SIZE + 1];
+  uint16_t len;
+
+  /* the MID is not known before */
+  len = reference(obs, counter, type, (m->buf[2] << 8) | m->buf[3], expected);
+  TEST_CHECK(m->len == len && memcmp(m->buf, expected, len) == 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_split(void)
+{
+  static uint8_t buffer[COAP_MAX_PACKET_SIZE + 1];
+  coap_packet_t packet[1];
+  uint16_t len, start, end;
+
+  /* the Observe option follows the ETag */
+  coap_init_message(packet, COAP_TYPE_NON, CONTENT_2_05, 0);
+  coap_set_header_etag(packet, (uint8_t *)"\x01\x02\x03", 3);
+  coap_set_header_observe(packet, 0x123);
+  coap_set_header_max_age(packet, 30);
+  len = coap_serialize_message(packet, buffer);
+  TEST_CHECK(notification_split(buffer, len, &start, &end));
+  TEST_CHECK(start == COAP_HEADER_LEN + 4 && end == start + 3);
+
+  /* an error has no Observe option, the header is all that differs */
+  coap_init_message(packet, COAP_TYPE_NON, NOT_FOUND_4_04, 0);
+  coap_set_header_max_age(packet, 30);
+  len = coap_serialize_message(packet, buffer);
+  TEST_CHECK(!notification_split(buffer, len, &start, &end));
+  TEST_CHECK(start == COAP_HEADER_LEN && end == COAP_HEADER_LEN);
+
+  /* neither has a message without options */
+  coap_init_message(packet, COAP_TYPE_NON, CONTENT_2_05, 0);
+  coap_set_payload(packet, "x", 1);
+  len = coap_serialize_message(packet, buffer);
+  TEST_CHECK(!notification_split(buffer, len, &start, &end));
+  TEST_CHECK(start == COAP_HEADER_LEN && end == COAP_HEADER_LEN);
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_notify(coap_observer_t **obs)
+{
+  /* counters where the Observe option gets longer */
+  static const int32_t counters[] = { 0, 0xfe, 0xfffe, 0xfffffe, 0xffffffe };
+  int32_t before[COAP_MAX_OBSERVERS];
+  int variant, round, i;
+
+  for(variant = 0; variant < 3; variant++) {
+    res_etag = variant == 1;
+    res_code = variant == 2 ? INTERNAL_SERVER_ERROR_5_00 : CONTENT_2_05;
+    for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+      obs[i]->obs_counter = counters[(variant + i) % 5];
+    }
+
+    for(round = 0; round < ROUNDS; round++) {
+      for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+        before[i] = obs[i]->obs_counter;
+      }
+      renders = 0;
+      sent_count = 0;
+      coap_notify_observers(&res_obs);
+
+      /* one rendering for all observers, notified in their order */
+      TEST_CHECK(renders == 1 && sent_count == COAP_MAX_OBSERVERS);
+      for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+        check_message(&sent[i], obs[i], before[i],
+                      before[i] % COAP_OBSERVE_REFRESH_INTERVAL == 0 ?
+                      COAP_TYPE_CON : COAP_TYPE_NON);
+      }
+
+      /* acknowledge the confirmable ones */
+      for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+        coap_clear_transaction(coap_get_transaction_by_mid(obs[i]->last_mid));
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_shared(coap_observer_t **obs)
+{
+  coap_transaction_t *t[COAP_MAX_OBSERVERS];
+  int i;
+
+  res_etag = 0;
+  res_code = CONTENT_2_05;
+  for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+    obs[i]->obs_counter = 0;
+  }
+  renders = 0;
+  sent_count = 0;
+  coap_notify_observers(&res_obs);
+
+  /* the confirmable notifications keep their head and share the end */
+  for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+    t[i] = coap_get_transaction_by_mid(obs[i]->last_mid);
+    TEST_CHECK(t[i] != NULL && t[i]->shared == t[0]->shared);
+    TEST_CHECK(t[i] != NULL && t[i]->packet == NULL &&
+               t[i]->stored.size == t[i]->packet_len);
+  }
+  TEST_CHECK(t[0]->shared != NULL &&
+             t[0]->shared->refs == COAP_MAX_OBSERVERS);
+
+  /* a retransmission is the same message again */
+  for(i = COAP_MAX_OBSERVERS - 1; i >= 0; i--) {
+    sent_count = 0;
+    etimer_stop(&t[i]->retrans_timer);
+    coap_check_transaction(&t[i]->retrans_timer);
+    TEST_CHECK(sent_count == 1);
+    check_message(&sent[0], obs[i], 0, COAP_TYPE_CON);
+    coap_clear_transaction(t[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+  static const uint8_t token[COAP_TOKEN_LEN] = "\xaa\xbb\xcc\xdd\xee\xff\x11";
+  coap_observer_t *obs[COAP_MAX_OBSERVERS];
+  uip_ipaddr_t addr;
+  int i;
+
+  mmem_init();
+  coap_init_connection(UIP_HTONS(COAP_DEFAULT_PORT), NULL);
+  res_obs.url = "obs";
+
+  /* observers with tokens of all lengths */
+  memset(&addr, 0, sizeof(addr));
+  for(i = 0; i < COAP_MAX_OBSERVERS; i++) {
+    addr.u8[15] = i;
+    obs[i] = coap_add_observer(&addr, 5683 + i, token,
+                               i * COAP_TOKEN_LEN / (COAP_MAX_OBSERVERS - 1),
+                               res_obs.url);
+    TEST_CHECK(obs[i] != NULL);
+  }
+
+  test_split();
+  test_notify(obs);
+  test_shared(obs);
+
+  return TEST_RESULT();
+}
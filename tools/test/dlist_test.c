@@ -0,0 +1,252 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         Doubly linked list test: a random trace of adds, pushes, pops,
+ *         chops, inserts and removals, checked against an array holding
+ *         the expected order. Also times the operations that walk a
+ *         singly linked list against their dlist counterparts for 10,
+ *         100 and 1000 elements.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "clist.h"
+#include "dlist.h"
+#include "test.h"
+
+struct elem {
+  struct elem *next;
+  struct elem *prev;
+};
+
+DLIST(dl);
+LIST(sl);
+
+static const int bench_sizes[] = { 10, 100, 1000 };
+
+#define BENCH_ROUNDS    200000
+#define TRACE_OPS       200000
+#define TRACE_ELEMS     64
+
+static struct elem elems[1000];
+static struct elem selems[1000];
+
+/* the expected content of the list, from head to tail */
+static struct elem *model[TRACE_ELEMS];
+static int model_len;
+
+/*---------------------------------------------------------------------------*/
+static int
+model_find(struct elem *e)
+{
+  int i;
+
+  for(i = 0; i < model_len; i++) {
+    if(model[i] == e) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+model_remove(struct elem *e)
+{
+  int i = model_find(e);
+
+  if(i >= 0) {
+    memmove(&model[i], &model[i + 1], (model_len - i - 1) * sizeof(model[0]));
+    model_len--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+model_insert(int pos, struct elem *e)
+{
+  memmove(&model[pos + 1], &model[pos], (model_len - pos) * sizeof(model[0]));
+  model[pos] = e;
+  model_len++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_list(void)
+{
+  struct elem *e;
+  struct elem *prev = NULL;
+  int i = 0;
+
+  for(e = dlist_head(dl); e != NULL && i < model_len; e = dlist_item_next(e)) {
+    TEST_CHECK(e == model[i]);
+    TEST_CHECK(dlist_item_prev(e) == prev);
+    prev = e;
+    i++;
+  }
+  TEST_CHECK(e == NULL && i == model_len);
+  TEST_CHECK(dlist_tail(dl) == prev);
+  TEST_CHECK(dlist_length(dl) == model_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_trace(void)
+{
+  struct elem *e;
+  struct elem *at;
+  int i;
+
+  srand(1);
+  for(i = 0; i < TRACE_OPS; i++) {
+    e = &elems[rand() % TRACE_ELEMS];
+
+    switch(rand() % 7) {
+    case 0:
+      dlist_add(dl, e);
+      model_remove(e);
+      model_insert(model_len, e);
+      break;
+    case 1:
+      dlist_push(dl, e);
+      model_remove(e);
+      model_insert(0, e);
+      break;
+    case 2:
+      dlist_remove(dl, e);
+      model_remove(e);
+      break;
+    case 3:
+      e = dlist_pop(dl);
+      TEST_CHECK(e == (model_len ? model[0] : NULL));
+      model_remove(e);
+      break;
+    case 4:
+      e = dlist_chop(dl);
+      TEST_CHECK(e == (model_len ? model[model_len - 1] : NULL));
+      model_remove(e);
+      break;
+    case 5:
+      /* insert after an element of the list, or at the head */
+      at = model_len ? model[rand() % model_len] : NULL;
+      if(at != e) {
+        dlist_insert(dl, at, e);
+        model_remove(e);
+        model_insert(at ? model_find(at) + 1 : 0, e);
+      }
+      break;
+    case 6:
+      TEST_CHECK(!!dlist_contains(dl, e) == (model_find(e) >= 0));
+      break;
+    }
+    if(i % 97 == 0) {
+      check_list();
+    }
+  }
+  check_list();
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(void)
+{
+  struct elem *e;
+  unsigned i, k, n;
+  double start, slist_ns, dlist_ns;
+
+  for(k = 0; k < sizeof(bench_sizes) / sizeof(bench_sizes[0]); k++) {
+    n = bench_sizes[k];
+    for(i = 0; i < n; i++) {
+      list_add(sl, &selems[i]);
+    }
+
+    /* remove an element from the middle and append it again */
+    start = test_now_ns();
+    for(i = 0; i < BENCH_ROUNDS; i++) {
+      e = &selems[(i * 7919) % n];
+      list_remove(sl, e);
+      list_add(sl, e);
+    }
+    slist_ns = (test_now_ns() - start) / BENCH_ROUNDS;
+    list_init(sl);
+
+    for(i = 0; i < n; i++) {
+      dlist_add(dl, &elems[i]);
+    }
+    start = test_now_ns();
+    for(i = 0; i < BENCH_ROUNDS; i++) {
+      e = &elems[(i * 7919) % n];
+      dlist_remove(dl, e);
+      dlist_add(dl, e);
+    }
+    dlist_ns = (test_now_ns() - start) / BENCH_ROUNDS;
+    TEST_CHECK(dlist_length(dl) == n);
+    printf("%4u elements: remove+add list %7.1f ns, dlist %5.1f ns\n",
+           n, slist_ns, dlist_ns);
+
+    /* tail and length, which list_tail()/list_length() get by walking */
+    for(i = 0; i < n; i++) {
+      list_add(sl, &selems[i]);
+    }
+    start = test_now_ns();
+    for(i = 0; i < BENCH_ROUNDS; i++) {
+      TEST_CHECK(list_tail(sl) == &selems[n - 1] && list_length(sl) == n);
+    }
+    slist_ns = (test_now_ns() - start) / BENCH_ROUNDS;
+    list_init(sl);
+
+    start = test_now_ns();
+    for(i = 0; i < BENCH_ROUNDS; i++) {
+      TEST_CHECK(dlist_tail(dl) != NULL && dlist_length(dl) == n);
+    }
+    dlist_ns = (test_now_ns() - start) / BENCH_ROUNDS;
+    printf("%4u elements: tail+length list %7.1f ns, dlist %5.1f ns\n",
+           n, slist_ns, dlist_ns);
+
+    /* the elements must be off the list before they are added again */
+    while(dlist_pop(dl) != NULL) {
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+  bench();
+  run_trace();
+
+  return TEST_RESULT();
+}
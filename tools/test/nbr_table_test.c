@@ -0,0 +1,205 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         Neighbor table test: a random trace of adds, removals, locks
+ *         and address changes over two tables, checking that every
+ *         neighbor is found by its link-layer address and nothing else
+ *         is. Also times the lookup for 10, 100 and 1000 neighbors.
+ *
+ *         Built once with the lladdr hash and once without it
+ *         (NBR_TABLE_CONF_HASH=0) to compare both.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbr-table.h"
+#include "test.h"
+
+typedef struct { int v; } item_a_t;
+typedef struct { int w; } item_b_t;
+
+NBR_TABLE(item_a_t, table_a);
+NBR_TABLE(item_b_t, table_b);
+
+static const int bench_sizes[] = { 10, 100, 1000 };
+
+#define BENCH_LOOKUPS   200000
+#define TRACE_OPS       100000
+#define TRACE_ADDRS     (NBR_TABLE_MAX_NEIGHBORS + NBR_TABLE_MAX_NEIGHBORS / 2)
+
+/*---------------------------------------------------------------------------*/
+static void
+make_lladdr(linkaddr_t *lladdr, uint8_t space, int n)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->u8[0] = space;
+  lladdr->u8[sizeof(*lladdr) - 2] = n >> 8;
+  lladdr->u8[sizeof(*lladdr) - 1] = n;
+}
+/*---------------------------------------------------------------------------*/
+static int
+table_contains(nbr_table_t *table, const linkaddr_t *lladdr)
+{
+  nbr_table_item_t *item;
+
+  for(item = nbr_table_head(table); item; item = nbr_table_next(table, item)) {
+    if(linkaddr_cmp(nbr_table_get_lladdr(table, item), lladdr)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_table(nbr_table_t *table)
+{
+  nbr_table_item_t *item;
+  linkaddr_t lladdr;
+  int i;
+
+  /* every neighbor is found under its own address */
+  for(item = nbr_table_head(table); item; item = nbr_table_next(table, item)) {
+    TEST_CHECK(nbr_table_get_from_lladdr(table,
+                 nbr_table_get_lladdr(table, item)) == item);
+  }
+  /* and a lookup only returns a neighbor with the requested address */
+  for(i = 0; i < TRACE_ADDRS; i++) {
+    make_lladdr(&lladdr, i & 1, i);
+    item = nbr_table_get_from_lladdr(table, &lladdr);
+    if(item != NULL) {
+      TEST_CHECK(linkaddr_cmp(nbr_table_get_lladdr(table, item), &lladdr));
+    } else {
+      TEST_CHECK(!table_contains(table, &lladdr));
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_lookup(void)
+{
+  linkaddr_t lladdr[1000];
+  unsigned i, n, k;
+  double start;
+
+  for(k = 0, n = 0; k < sizeof(bench_sizes) / sizeof(bench_sizes[0]); k++) {
+    if(bench_sizes[k] > NBR_TABLE_MAX_NEIGHBORS) {
+      break;
+    }
+    for(; n < bench_sizes[k]; n++) {
+      make_lladdr(&lladdr[n], 0xbe, n);
+      TEST_CHECK(nbr_table_add_lladdr(table_a, &lladdr[n]) != NULL);
+    }
+    start = test_now_ns();
+    for(i = 0; i < BENCH_LOOKUPS; i++) {
+      TEST_CHECK(nbr_table_get_from_lladdr(table_a, &lladdr[(i * 7919) % n]) != NULL);
+    }
+    printf("%4u neighbors: %6.1f ns per lookup\n", n,
+           (test_now_ns() - start) / BENCH_LOOKUPS);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+  nbr_table_t *table;
+  nbr_table_item_t *item;
+  linkaddr_t lladdr;
+  linkaddr_t other;
+  int i;
+
+  nbr_table_register(table_a, NULL);
+  nbr_table_register(table_b, NULL);
+
+  printf("lladdr hash %s\n", NBR_TABLE_HASH ? "on" : "off");
+  bench_lookup();
+
+  srand(1);
+  for(i = 0; i < TRACE_OPS; i++) {
+    table = rand() & 1 ? table_a : table_b;
+    make_lladdr(&lladdr, rand() & 1, rand() % TRACE_ADDRS);
+    item = nbr_table_get_from_lladdr(table, &lladdr);
+
+    switch(rand() % 6) {
+    case 0:
+    case 1:
+      item = nbr_table_add_lladdr(table, &lladdr);
+      if(item != NULL) {
+        TEST_CHECK(nbr_table_get_from_lladdr(table, &lladdr) == item);
+      }
+      break;
+    case 2:
+      if(item != NULL) {
+        nbr_table_remove(table, item);
+        TEST_CHECK(nbr_table_get_from_lladdr(table, &lladdr) == NULL);
+      }
+      break;
+    case 3:
+      if(item != NULL) {
+        nbr_table_lock(table, item);
+      }
+      break;
+    case 4:
+      if(item != NULL) {
+        nbr_table_unlock(table, item);
+      }
+      break;
+    case 5:
+      /* move the neighbor to an address nobody uses */
+      other = lladdr;
+      other.u8[1] = 1;
+      if(item != NULL && nbr_table_get_from_lladdr(table_a, &other) == NULL &&
+         nbr_table_get_from_lladdr(table_b, &other) == NULL) {
+        nbr_table_set_lladdr(table, item, &other);
+        TEST_CHECK(nbr_table_get_from_lladdr(table, &other) == item);
+        TEST_CHECK(nbr_table_get_from_lladdr(table, &lladdr) == NULL);
+      }
+      break;
+    }
+    if(i % 10000 == 0) {
+      check_table(table_a);
+      check_table(table_b);
+    }
+  }
+  check_table(table_a);
+  check_table(table_b);
+
+  return TEST_RESULT();
+}
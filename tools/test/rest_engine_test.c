@@ -0,0 +1,283 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         REST engine dispatch test: requests for exact paths, for paths
+ *         below resources with sub-resources and for unknown paths must
+ *         reach the right resource, also when resources did not fit into
+ *         the URI-path trie. Also times the dispatch for 10, 100 and
+ *         1000 resources.
+ *
+ *         Built once with a trie for all resources and once with a
+ *         single trie node (REST_TRIE_NODES=1), where the dispatch is
+ *         the linear scan of the resource list.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "emb6.h"
+#include "bsp.h"
+#include "er-coap.h"
+#include "rest-engine.h"
+#include "test.h"
+
+#define BENCH_REQUESTS  200000
+#define BENCH_RESOURCES 1000
+
+/* the request is only its URI path, the resource is reported on a hit */
+static const char *request_url;
+static resource_t *hit;
+
+static resource_t bench_resources[BENCH_RESOURCES];
+static char bench_paths[BENCH_RESOURCES][32];
+
+static const int bench_sizes[] = { 10, 100, 1000 };
+
+/* the REST engine takes the request from the CoAP implementation */
+static void init(void) {}
+static void set_service_callback(service_callback_t callback) {}
+
+static int
+get_url(void *request, const char **url)
+{
+  if(request_url == NULL) {
+    return 0;
+  }
+  *url = request_url;
+  return strlen(request_url);
+}
+
+static rest_resource_flags_t
+get_method_type(void *request)
+{
+  return METHOD_GET;
+}
+
+static int
+set_response_status(void *response, unsigned int code)
+{
+  return 1;
+}
+
+static void
+subscription_handler(resource_t *resource, void *request, void *response)
+{
+  hit = resource;
+}
+
+const struct rest_implementation coap_rest_implementation = {
+  .name = "test",
+  .init = init,
+  .set_service_callback = set_service_callback,
+  .get_url = get_url,
+  .get_method_type = get_method_type,
+  .set_response_status = set_response_status,
+  .subscription_handler = subscription_handler,
+};
+
+/* periodic resources are not tested */
+uint32_t bsp_get(en_bspParams_t param) { return 1; }
+void etimer_set(struct etimer *et, clock_time_t interval, pfn_callback_t func) {}
+int etimer_expired(struct etimer *et) { return 0; }
+void etimer_restart(struct etimer *et) {}
+
+/*---------------------------------------------------------------------------*/
+static void
+get_handler(void *request, void *response, uint8_t *buffer,
+            uint16_t preferred_size, int32_t *offset)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_resource(resource_t *resource, uint8_t flags)
+{
+  memset(resource, 0, sizeof(*resource));
+  resource->get_handler = get_handler;
+  /* the subscription handler reports the resource */
+  resource->flags = flags | IS_OBSERVABLE;
+}
+/*---------------------------------------------------------------------------*/
+static resource_t *
+dispatch(const char *url)
+{
+  hit = NULL;
+  request_url = url;
+  if(!rest_invoke_restful_service(NULL, NULL, NULL, 0, NULL)) {
+    return NULL;
+  }
+  return hit;
+}
+/*---------------------------------------------------------------------------*/
+#define CHECK_DISPATCH(path, expected) do { \
+    resource_t *r = dispatch(path); \
+    TEST_CHECK(r == (expected)); \
+    if(r != (expected)) { \
+      printf("  /%s reached %s\n", (path) ? (path) : "(null)", \
+             r ? r->url : "nothing"); \
+    } \
+  } while(0)
+/*---------------------------------------------------------------------------*/
+static void
+test_dispatch(void)
+{
+  static resource_t temp, inf, sensors, xy, core, dir;
+
+  rest_init_engine();
+  make_resource(&temp, 0);
+  make_resource(&inf, 0);
+  make_resource(&sensors, HAS_SUB_RESOURCES);
+  make_resource(&xy, 0);
+  make_resource(&core, 0);
+  make_resource(&dir, 0);
+  rest_activate_resource(&temp, "dev/temp");
+  rest_activate_resource(&inf, "dev/txrx/inf");
+  rest_activate_resource(&sensors, "sensors");
+  rest_activate_resource(&xy, "sensors/x/y");
+  rest_activate_resource(&core, ".well-known/core");
+  rest_activate_resource(&dir, "dir/");
+
+  CHECK_DISPATCH("dev/temp", &temp);
+  CHECK_DISPATCH("dev/temp/x", NULL);
+  CHECK_DISPATCH("dev", NULL);
+  CHECK_DISPATCH("dev/tem", NULL);
+  CHECK_DISPATCH("dev/temps", NULL);
+  CHECK_DISPATCH("dev/txrx/inf", &inf);
+  CHECK_DISPATCH(".well-known/core", &core);
+  CHECK_DISPATCH(NULL, NULL);
+  CHECK_DISPATCH("", NULL);
+  CHECK_DISPATCH("sensors", &sensors);
+  CHECK_DISPATCH("sensors/1", &sensors);
+  CHECK_DISPATCH("sensors/x", &sensors);
+  CHECK_DISPATCH("sensors/x/y", &xy);
+  CHECK_DISPATCH("sensors/x/y/z", &sensors);
+  CHECK_DISPATCH("sensors/", &sensors);
+  CHECK_DISPATCH("sensorsX", NULL);
+  CHECK_DISPATCH("dir/", &dir);
+  CHECK_DISPATCH("dir", NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_overflow(void)
+{
+  static resource_t filler[REST_TRIE_NODES];
+  static char filler_paths[REST_TRIE_NODES][8];
+  static resource_t p, pc, pcd, deep, xy, q, dup;
+  int i;
+
+  rest_init_engine();
+  make_resource(&p, HAS_SUB_RESOURCES);
+  make_resource(&pc, HAS_SUB_RESOURCES);
+  make_resource(&pcd, 0);
+  make_resource(&deep, 0);
+  make_resource(&xy, 0);
+  make_resource(&q, HAS_SUB_RESOURCES);
+  make_resource(&dup, 0);
+
+  rest_activate_resource(&p, "p");
+  /* leave three trie nodes */
+  for(i = 0; i < REST_TRIE_NODES - 4; i++) {
+    make_resource(&filler[i], 0);
+    sprintf(filler_paths[i], "f%d", i);
+    rest_activate_resource(&filler[i], filler_paths[i]);
+  }
+  /* needs four nodes, the partial branch must be released */
+  rest_activate_resource(&deep, "a/b/c/d");
+  rest_activate_resource(&xy, "x/y");
+  rest_activate_resource(&q, "q");
+  /* below a parent in the trie, but not in the trie themselves */
+  rest_activate_resource(&pc, "p/c");
+  rest_activate_resource(&pcd, "p/c/d");
+  /* the first resource of a path keeps it */
+  rest_activate_resource(&dup, "q");
+
+  CHECK_DISPATCH("p", &p);
+  CHECK_DISPATCH("p/c", &pc);
+  CHECK_DISPATCH("p/c/d", &pcd);
+  CHECK_DISPATCH("p/c/e", &pc);
+  CHECK_DISPATCH("p/c/d/e", &pc);
+  CHECK_DISPATCH("p/z", &p);
+  CHECK_DISPATCH("a/b/c/d", &deep);
+  CHECK_DISPATCH("a/b", NULL);
+  CHECK_DISPATCH("x/y", &xy);
+  CHECK_DISPATCH("x", NULL);
+  CHECK_DISPATCH("q", &q);
+  CHECK_DISPATCH("q/r", &q);
+  for(i = 0; i < REST_TRIE_NODES - 4; i++) {
+    CHECK_DISPATCH(filler_paths[i], &filler[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(void)
+{
+  unsigned i, k, n;
+  double start;
+
+  for(k = 0; k < sizeof(bench_sizes) / sizeof(bench_sizes[0]); k++) {
+    n = bench_sizes[k];
+    rest_init_engine();
+    for(i = 0; i < n; i++) {
+      make_resource(&bench_resources[i], 0);
+      sprintf(bench_paths[i], "obj/%u/res/%u", i / 10, i % 10);
+      rest_activate_resource(&bench_resources[i], bench_paths[i]);
+    }
+    for(i = 0; i < n; i++) {
+      CHECK_DISPATCH(bench_paths[i], &bench_resources[i]);
+    }
+
+    start = test_now_ns();
+    for(i = 0; i < BENCH_REQUESTS; i++) {
+      dispatch(bench_paths[(i * 7919) % n]);
+    }
+    printf("%4u resources: %7.1f ns per request\n", n,
+           (test_now_ns() - start) / BENCH_REQUESTS);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+  printf("%d trie nodes\n", REST_TRIE_NODES);
+  test_dispatch();
+  test_overflow();
+  bench();
+
+  return TEST_RESULT();
+}
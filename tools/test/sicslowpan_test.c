@@ -0,0 +1,357 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ * \file
+ *         6lowpan test: fragments of random datagrams arrive in random
+ *         order and repeatedly, and the block bitmap must count each
+ *         block once and report every repetition.
+ *
+ *         Random IPv6/UDP headers of a few flows with link-local,
+ *         context, global, multicast and unspecified addresses are
+ *         compressed, and each result must be the one of an empty flow
+ *         cache and must uncompress to the original header. Also times
+ *         the header compression of one flow.
+ *
+ *         Built once with the flow cache and once without it
+ *         (SICSLOWPAN_CONF_HC06_FLOWS=0) to compare both. The 6lowpan
+ *         layer is included so its static functions can be called.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "sicslowpan.c"
+#include "test.h"
+
+#define BENCH_PACKETS   10000000
+#define TRACE_PACKETS   200000
+#define TRACE_DATAGRAMS 20000
+#define FRAGS_MAX       (UIP_BUFSIZE / 8)
+
+/* uip6.c, tcpip.c, uip-ds6-nbr.c and bsp.c are not linked */
+uip_buf_t uip_aligned_buf;
+uint16_t uip_len;
+uip_lladdr_t uip_lladdr;
+
+void tcpip_set_outputfunc(uint8_t (* f)(const uip_lladdr_t *)) {}
+void uip_ds6_link_neighbor_callback(int status, int numtx) {}
+void bsp_wdt(en_bspWdtAction_t wdtAct) {}
+
+static const uint16_t ports[] = { 0xf0b1, 0xf012, 5683, 1234 };
+static const uint8_t ttls[] = { 1, 64, 255, 7 };
+
+/* compressed header and its length */
+struct frame {
+  uint8_t len;
+  uint8_t buf[UIP_IPUDPH_LEN + 2 * UIP_LLH_LEN];
+};
+
+static uint8_t uncompressed[UIP_BUFSIZE];
+
+/*---------------------------------------------------------------------------*/
+static void
+test_frag_mark(void)
+{
+  static uint16_t offsets[2 * FRAGS_MAX];
+  static uint8_t seen[FRAGS_MAX];
+  uint8_t blocks[(UIP_BUFSIZE / 8 + 8) / 8];
+  uint16_t received, size, offset, end;
+  int i, k, n, frags, blocks_new;
+
+  srand(1);
+  for(i = 0; i < TRACE_DATAGRAMS; i++) {
+    size = UIP_IPH_LEN + rand() % (UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPH_LEN);
+
+    /* fragments of 8 byte blocks, only the last one may be shorter */
+    for(frags = 0, offset = 0; offset < size; frags++) {
+      offsets[frags] = offset;
+      offset += 8 * (1 + rand() % 12);
+    }
+    offsets[frags] = size;
+
+    /* a random order, a third of the fragments arrive twice */
+    for(n = 0; n < frags; n++) {
+      seen[n] = 0;
+    }
+    memset(blocks, 0, sizeof(blocks));
+    received = 0;
+    blocks_new = 0;
+    for(n = frags + frags / 3; n > 0; n--) {
+      k = rand() % frags;
+      offset = offsets[k];
+      end = offsets[k + 1] < size ? offsets[k + 1] : size;
+
+      TEST_CHECK(frag_mark(blocks, &received, size, offset, end) == !seen[k]);
+      if(!seen[k]) {
+        blocks_new += (end - offset + 7) >> 3;
+        seen[k] = 1;
+      }
+      TEST_CHECK(received == blocks_new);
+    }
+    /* the missing ones complete the datagram */
+    for(k = 0; k < frags; k++) {
+      if(!seen[k]) {
+        end = offsets[k + 1] < size ? offsets[k + 1] : size;
+        TEST_CHECK(received < (size + 7) >> 3);
+        TEST_CHECK(frag_mark(blocks, &received, size, offsets[k], end));
+      }
+    }
+    TEST_CHECK(received == (size + 7) >> 3);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_ipaddr(uip_ipaddr_t *addr, int kind, const uip_lladdr_t *lladdr)
+{
+  memset(addr, 0, sizeof(*addr));
+  switch(kind) {
+  case 0:
+    /* link-local from the link-layer address */
+    uip_ip6addr_u8(addr, 0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(addr, (uip_lladdr_t *)lladdr);
+    break;
+  case 1:
+    /* link-local with a 16 bit IID */
+    uip_ip6addr_u8(addr, 0xfe, 0x80, 0, 0, 0, 0, 0, 0,
+                   0, 0, 0, 0xff, 0xfe, 0, rand() % 3, rand() % 3);
+    break;
+  case 2:
+    /* prefix of context 0, IID from the link-layer address */
+    uip_ip6addr_u8(addr, 0xaa, 0xaa, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(addr, (uip_lladdr_t *)lladdr);
+    break;
+  case 3:
+    /* prefix of context 0, other IID */
+    uip_ip6addr_u8(addr, 0xaa, 0xaa, 0, 0, 0, 0, 0, 0,
+                   0, 0, 0, 0, 0, 0, rand() % 2, 1);
+    break;
+  case 4:
+    /* global without a context */
+    uip_ip6addr_u8(addr, 0xbb, 0xbb, 0, 0, 0, 0, 0, 0,
+                   0, 0, 0, 0, 0, 0, 0, rand() % 3);
+    break;
+  case 5:
+    /* multicast, 8 bit */
+    uip_ip6addr_u8(addr, 0xff, 0x02, 0, 0, 0, 0, 0, 0,
+                   0, 0, 0, 0, 0, 0, 0, 1 + rand() % 2);
+    break;
+  case 6:
+    /* multicast, 32 bit */
+    uip_ip6addr_u8(addr, 0xff, 0x05, 0, 0, 0, 0, 0, 0,
+                   0, 0, 0, 0, 0, 0, rand() % 2, 1);
+    break;
+  case 7:
+    /* multicast, 48 bit */
+    uip_ip6addr_u8(addr, 0xff, 0x0e, 0, 0, 0, 0, 0, 0,
+                   0, 0, 1, 0, 0, 0, 0, 1);
+    break;
+  case 8:
+    /* multicast, inline */
+    uip_ip6addr_u8(addr, 0xff, 0x0e, 0, 1, 0, 0, 0, 0,
+                   0, 0, 0, 0, 0, 0, 0, 1);
+    break;
+  default:
+    /* unspecified */
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* a header without payload, the lengths are those uncompression infers */
+static void
+make_packet(linkaddr_t *link_destaddr)
+{
+  uip_lladdr_t lladdr;
+  int src = rand() % 10;
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[0] = rand() % 2 ? 2 : 0;
+  lladdr.addr[sizeof(lladdr) - 1] = rand() % 3;
+  if(rand() % 5) {
+    linkaddr_copy(link_destaddr, (linkaddr_t *)&lladdr);
+  } else {
+    linkaddr_copy(link_destaddr, &linkaddr_null);
+  }
+
+  memset(UIP_IP_BUF, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60 | (rand() % 4 == 0 ? rand() % 16 : 0);
+  if(rand() % 4 == 0) {
+    UIP_IP_BUF->tcflow = rand();
+    UIP_IP_BUF->flow = rand();
+  }
+  /* a multicast source is not valid */
+  make_ipaddr(&UIP_IP_BUF->srcipaddr, src >= 5 && src <= 8 ? 0 : src,
+              &uip_lladdr);
+  make_ipaddr(&UIP_IP_BUF->destipaddr, rand() % 10,
+              rand() % 2 ? &lladdr : &uip_lladdr);
+  UIP_IP_BUF->ttl = ttls[rand() % 4];
+
+  if(rand() % 3) {
+    UIP_IP_BUF->proto = UIP_PROTO_UDP;
+    UIP_IP_BUF->len[1] = UIP_UDPH_LEN;
+    UIP_UDP_BUF->srcport = UIP_HTONS(ports[rand() % 4]);
+    UIP_UDP_BUF->destport = UIP_HTONS(ports[rand() % 4]);
+    UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN);
+    UIP_UDP_BUF->udpchksum = rand();
+  } else {
+    UIP_IP_BUF->proto = UIP_PROTO_ICMP6;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+dump(const char *name, const uint8_t *data, int len)
+{
+  int i;
+
+  printf("  %s ", name);
+  for(i = 0; i < len; i++) {
+    printf("%02x", data[i]);
+  }
+  printf("\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+compress(linkaddr_t *link_destaddr, struct frame *frame)
+{
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  packetbuf_hdr_len = 0;
+  compress_hdr_hc06(link_destaddr);
+  frame->len = packetbuf_hdr_len;
+  memcpy(frame->buf, packetbuf_ptr, packetbuf_hdr_len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+uncompress(linkaddr_t *link_destaddr, struct frame *frame)
+{
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  memcpy(packetbuf_ptr, frame->buf, frame->len);
+  packetbuf_set_datalen(frame->len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, (linkaddr_t *)&uip_lladdr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, link_destaddr);
+  packetbuf_hdr_len = 0;
+  uncomp_hdr_len = 0;
+  sicslowpan_buf = uncompressed;
+  uncompress_hdr_hc06(0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+run_trace(void)
+{
+  linkaddr_t link_destaddr;
+  struct frame frame;
+  struct frame expected;
+  int i;
+  int mismatches = 0;
+
+  srand(1);
+  for(i = 0; i < TRACE_PACKETS; i++) {
+    make_packet(&link_destaddr);
+    compress(&link_destaddr, &frame);
+
+    /* the same packet compressed without the flows */
+#if SICSLOWPAN_HC06_FLOWS > 0
+    memset(hc06_flows, 0, sizeof(hc06_flows));
+#endif /* SICSLOWPAN_HC06_FLOWS > 0 */
+    compress(&link_destaddr, &expected);
+    if((frame.len != expected.len ||
+        memcmp(frame.buf, expected.buf, frame.len) != 0) &&
+       mismatches++ < 5) {
+      printf("packet %d: compressed header differs from an empty cache\n", i);
+    }
+
+    uncompress(&link_destaddr, &frame);
+    if(memcmp(&uncompressed[UIP_LLH_LEN], UIP_IP_BUF, uncomp_hdr_len) != 0 &&
+       mismatches++ < 5) {
+      printf("packet %d: uncompressed header differs\n", i);
+      dump("sent", (uint8_t *)UIP_IP_BUF, uncomp_hdr_len);
+      dump("got ", &uncompressed[UIP_LLH_LEN], uncomp_hdr_len);
+    }
+  }
+  TEST_CHECK(mismatches == 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(void)
+{
+  linkaddr_t link_destaddr;
+  int i;
+  double start;
+
+  /* a CoAP reply to a link-local neighbor */
+  memset(&link_destaddr, 0, sizeof(link_destaddr));
+  link_destaddr.u8[sizeof(link_destaddr) - 1] = 2;
+  memset(UIP_IP_BUF, 0, UIP_IPUDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  make_ipaddr(&UIP_IP_BUF->srcipaddr, 2, &uip_lladdr);
+  make_ipaddr(&UIP_IP_BUF->destipaddr, 2, (uip_lladdr_t *)&link_destaddr);
+  UIP_UDP_BUF->srcport = UIP_HTONS(5683);
+  UIP_UDP_BUF->destport = UIP_HTONS(1234);
+
+  start = test_now_ns();
+  for(i = 0; i < BENCH_PACKETS; i++) {
+    packetbuf_ptr = packetbuf_dataptr();
+    packetbuf_hdr_len = 0;
+    compress_hdr_hc06(&link_destaddr);
+  }
+  printf("flow cache %s: %5.1f ns per header\n",
+         SICSLOWPAN_HC06_FLOWS > 0 ? "on" : "off",
+         (test_now_ns() - start) / BENCH_PACKETS);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+  static const s_nsllsec_t llsec;
+  static const s_nsHighMac_t hmac;
+  static const s_nsFramer_t frame;
+  static s_ns_t ns = { .llsec = &llsec, .hmac = &hmac, .frame = &frame };
+
+  uip_lladdr.addr[0] = 2;
+  uip_lladdr.addr[sizeof(uip_lladdr) - 1] = 1;
+  sicslowpan_init(&ns);
+
+  test_frag_mark();
+  bench();
+  run_trace();
+
+  return TEST_RESULT();
+}
@@ -75,6 +75,7 @@
  =============================================================================*/
 struct ctimer {
   struct     ctimer         *next;
+  struct     ctimer         *prev;
   struct     etimer         etimer;
               void             (*f)(void *);
               void             *ptr;
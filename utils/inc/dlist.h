@@ -0,0 +1,126 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/**
+ *   \addtogroup utils
+ *   @{ */
+/** \addtogroup lib
+    @{ */
+/**
+ * \defgroup dlist Doubly linked list library
+ *
+ * The doubly linked list library keeps a pointer to the tail and the
+ * number of elements of each list, so that adding or removing an
+ * element at either end, removing an element from inside the list
+ * and getting the length of the list take constant time.
+ *
+ * A doubly linked list is made up of elements where the first element
+ * \b must be a pointer to the next element and the second element
+ * \b must be a pointer to the previous element. An element may be on
+ * at most one list at a time, and its pointers must be NULL before it
+ * is first added, which is the case for static or memb() allocated
+ * elements.
+ *
+ * Lists are declared with the DLIST() macro. Unlike the functions of
+ * the \ref list "list library", dlist_add() and dlist_push() move an
+ * element that already is on the list.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ * Doubly linked list manipulation routines.
+ */
+
+#ifndef DLIST_H_
+#define DLIST_H_
+
+#define DLIST_CONCAT2(s1, s2) s1##s2
+#define DLIST_CONCAT(s1, s2) DLIST_CONCAT2(s1, s2)
+
+/**
+ * Declare a doubly linked list.
+ *
+ * The list variable is declared as static to make it easy to use in a
+ * single C module without unnecessarily exporting the name to other
+ * modules.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST(name) \
+         static struct dlist DLIST_CONCAT(name,_dlist) = { 0, 0, 0 }; \
+         static dlist_t name = &DLIST_CONCAT(name,_dlist)
+
+struct dlist {
+  void *head;
+  void *tail;
+  unsigned short length;
+};
+
+/**
+ * The doubly linked list type.
+ *
+ */
+typedef struct dlist * dlist_t;
+
+void   dlist_init(dlist_t list);
+void * dlist_head(dlist_t list);
+void * dlist_tail(dlist_t list);
+void * dlist_pop (dlist_t list);
+void   dlist_push(dlist_t list, void *item);
+
+void * dlist_chop(dlist_t list);
+
+void   dlist_add(dlist_t list, void *item);
+void   dlist_remove(dlist_t list, void *item);
+int    dlist_contains(dlist_t list, void *item);
+
+int    dlist_length(dlist_t list);
+
+void   dlist_insert(dlist_t list, void *previtem, void *newitem);
+
+void * dlist_item_next(void *item);
+void * dlist_item_prev(void *item);
+
+#endif /* DLIST_H_ */
+
+/** @} */
+/** @} */
+/** @} */
@@ -83,9 +83,12 @@
                         STRUCTURES AND OTHER TYPEDEFS
  =============================================================================*/
 struct etimer {
-    struct     etimer     *next; /**<  Pointer to the next etimer structure in list */
+    struct     etimer     *next; /**<  Pointer to the next sibling in the timer heap */
+    struct     etimer     *child; /**<  Pointer to the first child in the timer heap */
+    struct     etimer     *prev; /**<  Pointer to the parent or previous sibling */
     struct     timer     timer; /**<  Structure to store start timestamp and interval.*/
     uint8_t    active;/**<  Flag indicating either etimer has expired or not*/
+    pfn_callback_t callback;/**<  Function to be called when the timer expires */
 };
 
 
@@ -97,8 +100,8 @@ struct etimer {
  *
  *             This function is used to set an event timer for a time
  *             sometime in the future. When the event timer expires,
- *             the event PROCESS_EVENT_TIMER will be posted to the
- *             process that called the etimer_set() function.
+ *             the event EVENT_TYPE_TIMER_EXP will be delivered to the
+ *             given callback only.
  *
  */
 void etimer_set(struct etimer *et, clock_time_t interval, pfn_callback_t callback);
@@ -243,7 +246,8 @@ int etimer_pending(void);
  *           returns 0.
  *
  *             This functions returns next expiration time of all
- *             pending event timers.
+ *             pending event timers. The earliest timer is always kept
+ *             on top of the timer heap, so this is an O(1) call.
  */
 clock_time_t etimer_next_expiration_time(void);
 
@@ -89,13 +89,36 @@
 #define EVENT_TYPE_ICMP6            0x05    ///< New icmp6 packet event
 #define EVENT_TYPE_TCPIP            0x06    ///< New tcpip event
 #define EVENT_TYPE_SLIP_POLL        0x07    ///< Process slip handler
-#define OBLIG_EVENT_PRIOR           0x0a
 #define EVENT_TYPE_PCK_LL           0x0a    ///< New low level packet received
 
 
+#define EVENT_TYPE_MAX             EVENT_TYPE_PCK_LL ///< Biggest value of an event type
 #define EVENT_TYPES_COUNT           8       ///< Counter of events in /ref EVENT_TYPES macro
-#define MAX_CALLBACK_COUNT          7       ///< Maximal amount of callbacks in /ref st_funcRegList_t list
-#define EVPROC_QUEUE_SIZE           20      ///< Maximal amount of events in /ref pst_evList queue
+
+/// Maximal amount of callbacks in /ref st_funcReg_t list
+#ifdef EVPROC_CONF_MAX_CALLBACK_COUNT
+#define MAX_CALLBACK_COUNT          EVPROC_CONF_MAX_CALLBACK_COUNT
+#else
+#define MAX_CALLBACK_COUNT          7
+#endif /* EVPROC_CONF_MAX_CALLBACK_COUNT */
+
+/// Depth of every priority lane of the event queue. Must be a power of two
+/// and not bigger than 128.
+#ifdef EVPROC_CONF_QUEUE_SIZE
+#define EVPROC_QUEUE_SIZE           EVPROC_CONF_QUEUE_SIZE
+#else
+#define EVPROC_QUEUE_SIZE           16
+#endif /* EVPROC_CONF_QUEUE_SIZE */
+
+#if (EVPROC_QUEUE_SIZE & (EVPROC_QUEUE_SIZE - 1)) != 0
+#error "EVPROC_QUEUE_SIZE must be a power of two"
+#endif
+
+#if EVPROC_QUEUE_SIZE > 128
+#error "EVPROC_QUEUE_SIZE must not be bigger than 128"
+#endif
+
+#define EVPROC_PRIO_COUNT           3       ///< Amount of priority lanes, see \ref en_evprocPrio_t
 /*=============================================================================
                                  ENUMS
  =============================================================================*/
@@ -121,6 +144,19 @@ typedef enum {
     E_EVPROC_EXEC            ///< Call all subscribed functions immediately
 }en_evprocAction_t;
 
+/*!
+ * \brief Priority lanes of the event queue.
+ *
+ * Lanes are served strictly in order: an event of a lower lane is only
+ * taken when all lanes above are empty. Inside a lane events are taken in
+ * the order they were put.
+ * */
+typedef enum {
+    E_EVPROC_PRIO_HIGH   = 0,  ///< Link layer input, never coalesced
+    E_EVPROC_PRIO_NORMAL = 1,  ///< Events put with \ref E_EVPROC_HEAD
+    E_EVPROC_PRIO_LOW    = 2   ///< Events put with \ref E_EVPROC_TAIL
+}en_evprocPrio_t;
+
 /*=============================================================================
                         STRUCTURES AND OTHER TYPEDEFS
  =============================================================================*/
@@ -133,6 +169,18 @@ typedef void *    p_data_t;
 /*! Type of a callback function */
 typedef void         (*pfn_callback_t)( c_event_t c_event, p_data_t p_data );
 
+/*!
+ * \struct st_evprocStats_t
+ *
+ * \brief Statistics of the event queue. Indexed by \ref en_evprocPrio_t
+ * */
+typedef struct {
+    uint32_t    l_put[EVPROC_PRIO_COUNT];       ///< Events added to a lane
+    uint32_t    l_dropped[EVPROC_PRIO_COUNT];   ///< Events lost due to a full lane
+    uint32_t    l_coalesced;                    ///< Duplicates merged with a queued event
+    uint8_t     c_maxDepth[EVPROC_PRIO_COUNT];  ///< High-water mark of a lane
+}st_evprocStats_t;
+
 
 
 /*==============================================================================
@@ -203,7 +251,8 @@ en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_
 \brief   Unregister callback function for a particular event
 
          This function searching for a given function pointer in a registration
-         list and delete it in case of success.
+         list and delete it in case of success. Remaining callbacks are moved
+         up, so the list stays without holes and keeps registration order.
 
 \param  c_evenType            Type of event on which we want to register callback
 \param    pfn_callback        Pointer on the function which should be called
@@ -221,8 +270,12 @@ en_evprocResCode_t evproc_unregCallback(    c_event_t         c_evenType, \
 /*!
 \brief   Process input event in accordance with an action type.
 
-         The event process route works with FIFO buffer with an ability to add
-         new elements not only in a head, but also in a tail of a queue.
+         The event process route works with a set of FIFO ring buffers, one
+         per priority lane. \ref EVENT_TYPE_PCK_LL is always put into
+         \ref E_EVPROC_PRIO_HIGH lane, \ref E_EVPROC_HEAD events into
+         \ref E_EVPROC_PRIO_NORMAL and \ref E_EVPROC_TAIL events into
+         \ref E_EVPROC_PRIO_LOW. An event of a normal or low lane which is
+         already waiting in the queue with the same data is not added twice.
 
 \param  e_actType            Action type - what should be done with this event.
                             See \ref en_evprocAction_t
@@ -230,7 +283,7 @@ en_evprocResCode_t evproc_unregCallback(    c_event_t         c_evenType, \
 \param    p_data                Pointer on the function which should be called
                             whenever c_event_type was generated.
 
-\return    \ref E_END_OF_LIST        End of a queue has been reached.
+\return    \ref E_END_OF_LIST        Lane is full, event was dropped.
 \return    \ref E_UNKNOWN_TYPE        Unknown type of an action.
 \return \ref E_SUCCESS            Event was executed or added to the queue.
 */
@@ -239,12 +292,39 @@ en_evprocResCode_t evproc_putEvent(    en_evprocAction_t     e_actType, \
                                         c_event_t             c_eventType, \
                                         p_data_t             p_data);
 
+/*============================================================================*/
+/*!
+\brief   Process input event which is addressed to a single callback.
+
+         Works the same way as \ref evproc_putEvent, but once the event is
+         taken from the queue only pfn_target is called instead of every
+         callback registered for c_eventType. Typically used for events whose
+         data identifies an owner, e.g. an expired etimer.
+
+\param  e_actType            Action type - what should be done with this event.
+                            See \ref en_evprocAction_t
+\param  c_eventType            Type of an event.
+\param    p_data                Pointer to a data associated with the event.
+\param    pfn_target            Callback to deliver the event to. If NULL
+                            the event is delivered to all subscribers.
+
+\return    \ref E_END_OF_LIST        Lane is full, event was dropped.
+\return    \ref E_UNKNOWN_TYPE        Unknown type of an action.
+\return \ref E_SUCCESS            Event was executed or added to the queue.
+*/
+/*============================================================================*/
+en_evprocResCode_t evproc_putTargetEvent(en_evprocAction_t     e_actType, \
+                                        c_event_t             c_eventType, \
+                                        p_data_t             p_data, \
+                                        pfn_callback_t       pfn_target);
+
 /*============================================================================*/
 /*!
 \brief   Take next event from the queue compare with a registration list and
         call all of subscribers.
 
-         This function takes event only from the head of a queue
+         This function takes event from the head of the highest non-empty
+         priority lane
 
 \return    \ref E_QUEUE_EMPTY        No events in the queue.
 \return    \ref E_UNKNOWN_TYPE        Input type of an event was not found in the
@@ -254,6 +334,18 @@ en_evprocResCode_t evproc_putEvent(    en_evprocAction_t     e_actType, \
 /*============================================================================*/
 en_evprocResCode_t evproc_nextEvent(void);
 
+/*============================================================================*/
+/*!
+\brief   Get statistics of the event queue.
+
+\param  pst_stats            Pointer to a structure to be filled.
+
+\return    \ref E_INVALID_PARAM    NULL pointer was given.
+\return \ref E_SUCCESS            Statistics copied.
+*/
+/*============================================================================*/
+en_evprocResCode_t evproc_getStats(st_evprocStats_t *pst_stats);
+
 
 
 #endif /* EVPROC_H_ */
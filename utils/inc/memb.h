@@ -66,6 +66,8 @@
 #ifndef MEMB_H_
 #define MEMB_H_
 
+#include <stdint.h>
+
 #include "cc.h"
 
 /**
@@ -90,17 +92,22 @@ MEMB(connections, struct connection, 16);
  *
  */
 #define MEMB(name, structure, num) \
-        static char CC_CONCAT(name,_memb_count)[num]; \
+        static uint32_t CC_CONCAT(name,_memb_used)[((num) + 31) / 32]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
-                                          CC_CONCAT(name,_memb_count), \
-                                          (void *)CC_CONCAT(name,_memb_mem)}
+                                          CC_CONCAT(name,_memb_used), \
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          0, 0}
 
 struct memb {
   unsigned short size;
   unsigned short num;
-  char *count;
+  /* One bit per block, set while the block is allocated */
+  uint32_t *used;
   void *mem;
+  /* Number of allocated blocks and highest value it reached */
+  unsigned short nused;
+  unsigned short hiwater;
 };
 
 /**
@@ -135,6 +142,14 @@ int memb_inmemb(struct memb *m, void *ptr);
 
 int  memb_numfree(struct memb *m);
 
+/**
+ * Get the highest number of blocks allocated at the same time since
+ * the memory block was initialized.
+ *
+ * \param m A memory block previously declared with MEMB().
+ */
+int  memb_hiwater(struct memb *m);
+
 /** @} */
 /** @} */
 /** @} */
@@ -318,6 +318,65 @@ int packetbuf_hdralloc(int size);
  */
 int packetbuf_hdrreduce(int size);
 
+struct packetbuf_frame;
+
+/**
+ * \brief      A reference to the frame storage of the packetbuf
+ *
+ *             A descriptor records the header and data positions of
+ *             the packet along with a reference on the frame holding
+ *             it, so that the packet can be queued and loaded back
+ *             into the packetbuf without being copied.
+ */
+struct packetbuf_desc {
+  struct packetbuf_frame *frame;
+  uint16_t bufptr;
+  uint16_t buflen;
+  uint8_t hdrptr;
+};
+
+/**
+ * \brief      Take a reference on the packet in the packetbuf
+ * \param d    The descriptor to fill in
+ *
+ *             The packetbuf keeps using the same frame until it is
+ *             cleared, so the data must not be modified in place
+ *             while the descriptor is held. Adding a header with
+ *             packetbuf_hdralloc() is safe. Must not be called when
+ *             the packetbuf references external data.
+ */
+void packetbuf_desc_hold(struct packetbuf_desc *d);
+
+/**
+ * \brief      Make the packetbuf use the packet of a descriptor
+ * \param d    A descriptor filled in by packetbuf_desc_hold()
+ *
+ *             The header and data of the packetbuf are set back to
+ *             the ones recorded in the descriptor, which stays
+ *             valid. Attributes are left untouched.
+ */
+void packetbuf_desc_load(const struct packetbuf_desc *d);
+
+/**
+ * \brief      Drop the reference taken by packetbuf_desc_hold()
+ * \param d    The descriptor to release
+ */
+void packetbuf_desc_release(struct packetbuf_desc *d);
+
+/**
+ * \brief      Get a pointer to the packet of a descriptor
+ * \param d    A descriptor filled in by packetbuf_desc_hold()
+ * \retval     A pointer to the header followed by the data
+ */
+void *packetbuf_desc_ptr(const struct packetbuf_desc *d);
+
+/**
+ * \brief      Get the length of the packet of a descriptor
+ * \param d    A descriptor filled in by packetbuf_desc_hold()
+ * \retval     The length of the header and data
+ */
+uint16_t packetbuf_desc_len(const struct packetbuf_desc *d);
+
 /* Packet attributes stuff below: */
 
 typedef uint16_t packetbuf_attr_t;
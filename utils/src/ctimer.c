@@ -66,7 +66,7 @@
 #include "evproc.h"
 #include "ctimer.h"
 #include "timer.h"
-#include "clist.h"
+#include "dlist.h"
 
 /*==============================================================================
                              LOCAL MACROS
@@ -80,7 +80,7 @@
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
-LIST(gp_ctimList);
+DLIST(gp_ctimList);
 static     char         gc_init = 0;
 
 void ctimer_refresh(c_event_t event, void * data);
@@ -97,17 +97,15 @@ void ctimer_refresh(c_event_t event, void * data);
  */
 void ctimer_refresh(c_event_t event, void * data)
 {
-    struct ctimer *pst_cTim;
-    for(pst_cTim = list_head(gp_ctimList); \
-        pst_cTim != NULL; \
-        pst_cTim = pst_cTim->next) {
-      if(&pst_cTim->etimer == data) {
-          list_remove(gp_ctimList, pst_cTim);
-          if(pst_cTim->f != NULL) {
-              pst_cTim->f(pst_cTim->ptr);
-          }
-          break;
-      }
+    struct ctimer *pst_cTim = (struct ctimer *)((uint8_t *)data -
+                              offsetof(struct ctimer, etimer));
+
+    /* the event may still be queued for a timer stopped meanwhile */
+    if(dlist_contains(gp_ctimList, pst_cTim)) {
+        dlist_remove(gp_ctimList, pst_cTim);
+        if(pst_cTim->f != NULL) {
+            pst_cTim->f(pst_cTim->ptr);
+        }
     }
 }
 /*==============================================================================
@@ -122,8 +120,9 @@ void ctimer_init(void)
         return;
     etimer_init();
     struct ctimer *c;
-    list_init(gp_ctimList);
-    for(c = list_head(gp_ctimList); c != NULL; c = c->next) {
+    /* Arm the timers which were set before initialization. The list is
+       not emptied, its elements would keep stale links otherwise. */
+    for(c = dlist_head(gp_ctimList); c != NULL; c = c->next) {
         etimer_set(&c->etimer, c->etimer.timer.interval, ctimer_refresh);
     }
     gc_init = 1;
@@ -143,7 +142,7 @@ void ctimer_set(struct ctimer *c, clock_time_t t,
         c->etimer.timer.interval = t;
     }
 
-    list_add(gp_ctimList, c);
+    dlist_add(gp_ctimList, c);
 }
 /*============================================================================*/
 /*  ctimer_reset()                                                     */
@@ -154,8 +153,7 @@ void ctimer_reset(struct ctimer *c)
     etimer_reset(&c->etimer);
   }
 
-  list_remove(gp_ctimList, c);
-  list_add(gp_ctimList, c);
+  dlist_add(gp_ctimList, c);
 }
 /*============================================================================*/
 /*  ctimer_restart()                                                     */
@@ -166,8 +164,7 @@ void ctimer_restart(struct ctimer *c)
     etimer_restart(&c->etimer);
   }
 
-  list_remove(gp_ctimList, c);
-  list_add(gp_ctimList, c);
+  dlist_add(gp_ctimList, c);
 }
 /*============================================================================*/
 /*  ctimer_stop()                                                     */
@@ -180,22 +177,16 @@ void ctimer_stop(struct ctimer *pst_stopTim)
         pst_stopTim->etimer.next = NULL;
         pst_stopTim->etimer.active = TMR_NOT_ACTIVE;
     }
-    list_remove(gp_ctimList, pst_stopTim);
+    dlist_remove(gp_ctimList, pst_stopTim);
 }
 /*============================================================================*/
 /*  ctimer_expired()                                                     */
 /*============================================================================*/
 int ctimer_expired(struct ctimer *pst_checkTim)
 {
-    struct ctimer *pst_t;
     if(gc_init) {
         return etimer_expired(&pst_checkTim->etimer);
     }
-    for(pst_t = list_head(gp_ctimList); pst_t != NULL; pst_t = pst_t->next) {
-        if(pst_t == pst_checkTim) {
-            return 0;
-        }
-    }
-    return 1;
+    return !dlist_contains(gp_ctimList, pst_checkTim);
 }
 /** @} */
@@ -0,0 +1,300 @@
+/*
+ * emb6 is licensed under the 3-clause BSD license. This license gives everyone
+ * the right to use and distribute the code, either in binary or source code
+ * format, as long as the copyright license is retained in the source code.
+ *
+ * The emb6 is derived from the Contiki OS platform with the explicit approval
+ * from Adam Dunkels. However, emb6 is made independent from the OS through the
+ * removal of protothreads. In addition, APIs are made more flexible to gain
+ * more adaptivity during run-time.
+ *
+ * The license text is:
+ *
+ * Copyright (c) 2015,
+ * Hochschule Offenburg, University of Applied Sciences
+ * Laboratory Embedded Systems and Communications Electronics.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * \addtogroup dlist
+ * @{
+ */
+
+/**
+ * \file
+ * Doubly linked list library implementation.
+ *
+ */
+
+#include "dlist.h"
+
+#define NULL 0
+
+struct dlist_item {
+  struct dlist_item *next;
+  struct dlist_item *prev;
+};
+
+/*---------------------------------------------------------------------------*/
+/**
+ * Initialize a list.
+ *
+ * This function initalizes a list. The list will be empty after this
+ * function has been called.
+ *
+ * \param list The list to be initialized.
+ */
+void
+dlist_init(dlist_t list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+  list->length = 0;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the first element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the first element on the list.
+ */
+void *
+dlist_head(dlist_t list)
+{
+  return list->head;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get the tail of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the last element on the list.
+ */
+void *
+dlist_tail(dlist_t list)
+{
+  return list->tail;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Check whether an element is on a list.
+ *
+ * \param list The list.
+ * \param item The element.
+ * \return Non-zero if the element is on the list.
+ */
+int
+dlist_contains(dlist_t list, void *item)
+{
+  return ((struct dlist_item *)item)->prev != NULL || list->head == item;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an item at the end of a list.
+ *
+ * If the element already is on the list, it is moved to the end.
+ *
+ * \param list The list.
+ * \param item A pointer to the item to be added.
+ */
+void
+dlist_add(dlist_t list, void *item)
+{
+  struct dlist_item *l = item;
+
+  dlist_remove(list, item);
+
+  l->next = NULL;
+  l->prev = list->tail;
+  if(list->tail == NULL) {
+    list->head = l;
+  } else {
+    ((struct dlist_item *)list->tail)->next = l;
+  }
+  list->tail = l;
+  list->length++;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an item to the start of the list.
+ *
+ * If the element already is on the list, it is moved to the start.
+ *
+ * \param list The list.
+ * \param item A pointer to the item to be added.
+ */
+void
+dlist_push(dlist_t list, void *item)
+{
+  struct dlist_item *l = item;
+
+  dlist_remove(list, item);
+
+  l->prev = NULL;
+  l->next = list->head;
+  if(list->head == NULL) {
+    list->tail = l;
+  } else {
+    ((struct dlist_item *)list->head)->prev = l;
+  }
+  list->head = l;
+  list->length++;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the last object on the list.
+ *
+ * \param list The list.
+ * \return The removed object, or NULL if the list was empty.
+ */
+void *
+dlist_chop(dlist_t list)
+{
+  void *l = list->tail;
+
+  if(l != NULL) {
+    dlist_remove(list, l);
+  }
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the first object on a list.
+ *
+ * \param list The list.
+ * \return The removed object, or NULL if the list was empty.
+ */
+void *
+dlist_pop(dlist_t list)
+{
+  void *l = list->head;
+
+  if(l != NULL) {
+    dlist_remove(list, l);
+  }
+  return l;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove a specific element from a list.
+ *
+ * Nothing happens if the element is not on the list.
+ *
+ * \param list The list.
+ * \param item The item that is to be removed from the list.
+ */
+void
+dlist_remove(dlist_t list, void *item)
+{
+  struct dlist_item *l = item;
+
+  if(!dlist_contains(list, item)) {
+    return;
+  }
+
+  if(l->prev == NULL) {
+    list->head = l->next;
+  } else {
+    l->prev->next = l->next;
+  }
+  if(l->next == NULL) {
+    list->tail = l->prev;
+  } else {
+    l->next->prev = l->prev;
+  }
+  l->next = NULL;
+  l->prev = NULL;
+  list->length--;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get the length of a list.
+ *
+ * \param list The list.
+ * \return The number of elements on the list.
+ */
+int
+dlist_length(dlist_t list)
+{
+  return list->length;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Insert an item after a specified item on the list
+ * \param list The list
+ * \param previtem The item after which the new item should be inserted
+ * \param newitem  The new item that is to be inserted
+ *
+ *             If previtem is NULL, the new item is placed at the
+ *             start of the list.
+ */
+void
+dlist_insert(dlist_t list, void *previtem, void *newitem)
+{
+  struct dlist_item *p = previtem;
+  struct dlist_item *l = newitem;
+
+  if(p == NULL) {
+    dlist_push(list, newitem);
+    return;
+  }
+
+  dlist_remove(list, newitem);
+
+  l->prev = p;
+  l->next = p->next;
+  if(p->next == NULL) {
+    list->tail = l;
+  } else {
+    p->next->prev = l;
+  }
+  p->next = l;
+  list->length++;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the next item following this item
+ * \param item A list item
+ * \returns    A next item on the list
+ */
+void *
+dlist_item_next(void *item)
+{
+  return item == NULL ? NULL : ((struct dlist_item *)item)->next;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the item preceding this item
+ * \param item A list item
+ * \returns    The previous item on the list
+ */
+void *
+dlist_item_prev(void *item)
+{
+  return item == NULL ? NULL : ((struct dlist_item *)item)->prev;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
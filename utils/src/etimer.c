@@ -53,6 +53,11 @@
             The first one push callbacks after timer expires and the second one
             push event when timer expires.
 
+            Active timers are kept in an intrusive pairing heap ordered by
+            expiration time. Setting a timer is O(1), stopping or expiring
+            one is O(log n) amortized and the earliest deadline is always
+            the root of the heap.
+
   \version  0.1
 */
 /*============================================================================*/
@@ -62,7 +67,6 @@
 ==============================================================================*/
 
 #include "etimer.h"
-#include "clist.h"
 
 #include "emb6_conf.h"
 #include "emb6.h"
@@ -81,15 +85,138 @@
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
-static             clock_time_t     l_nextExp = 0;
-LIST(gp_etimList);
+/*! Root of the timer heap, the timer which expires first */
+static     struct etimer *  gp_etimHeap = NULL;
 static     char         gc_init = 0;
 /*==============================================================================
                              LOCAL FUNCTIONS
 ==============================================================================*/
 /*============================================================================*/
 /*!
-*   \brief   Add timer to the timer list
+*   \brief   Check whether one timer expires before another one
+*
+*            Expiration times are compared as a signed difference, so the
+*            order stays correct across a wrap of the tick counter.
+*/
+/*============================================================================*/
+static uint8_t _etimer_before(struct etimer *pst_a, struct etimer *pst_b)
+{
+    return (int32_t)(etimer_expiration_time(pst_a) -
+                     etimer_expiration_time(pst_b)) < 0;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Meld two detached heaps
+*
+*    \param        pst_a        Root of the first heap or NULL
+*    \param        pst_b        Root of the second heap or NULL
+*    \retval        Root of the resulting heap
+*/
+/*============================================================================*/
+static struct etimer *_etimer_meld(struct etimer *pst_a, struct etimer *pst_b)
+{
+    struct etimer *pst_tmp;
+
+    if (pst_a == NULL)
+        return pst_b;
+    if (pst_b == NULL)
+        return pst_a;
+
+    if (_etimer_before(pst_b, pst_a)) {
+        pst_tmp = pst_a;
+        pst_a = pst_b;
+        pst_b = pst_tmp;
+    }
+    // Later timer becomes the first child of the earlier one
+    pst_b->prev = pst_a;
+    pst_b->next = pst_a->child;
+    if (pst_a->child != NULL)
+        pst_a->child->prev = pst_b;
+    pst_a->child = pst_b;
+    return pst_a;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Merge a list of sibling heaps into one heap (two-pass pairing)
+*
+*    \param        pst_first        First sibling or NULL
+*    \retval        Root of the resulting heap
+*/
+/*============================================================================*/
+static struct etimer *_etimer_mergePairs(struct etimer *pst_first)
+{
+    struct etimer *pst_a;
+    struct etimer *pst_b;
+    struct etimer *pst_pairs = NULL;
+    struct etimer *pst_root = NULL;
+
+    // First pass: meld siblings pairwise from left to right and keep the
+    // results in a stack linked by the next pointer
+    while (pst_first != NULL) {
+        pst_a = pst_first;
+        pst_b = pst_a->next;
+        pst_first = (pst_b != NULL) ? pst_b->next : NULL;
+        pst_a->next = NULL;
+        pst_a->prev = NULL;
+        if (pst_b != NULL) {
+            pst_b->next = NULL;
+            pst_b->prev = NULL;
+        }
+        pst_a = _etimer_meld(pst_a, pst_b);
+        pst_a->next = pst_pairs;
+        pst_pairs = pst_a;
+    }
+
+    // Second pass: meld the pairs from right to left
+    while (pst_pairs != NULL) {
+        pst_a = pst_pairs;
+        pst_pairs = pst_a->next;
+        pst_a->next = NULL;
+        pst_root = _etimer_meld(pst_root, pst_a);
+    }
+    return pst_root;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Remove timer from the timer heap
+*
+*    \param        pst_timer        Pointer to a timer to be removed
+*    \retval        none
+*/
+/*============================================================================*/
+static void _etimer_removeTimer(struct etimer *pst_timer)
+{
+    struct etimer *pst_sub;
+
+    if (pst_timer->active != TMR_ACTIVE)
+        return;
+
+    if (pst_timer == gp_etimHeap) {
+        gp_etimHeap = _etimer_mergePairs(pst_timer->child);
+    }
+    else if (pst_timer->prev != NULL) {
+        // Unlink from the parent or from the previous sibling
+        if (pst_timer->prev->child == pst_timer)
+            pst_timer->prev->child = pst_timer->next;
+        else
+            pst_timer->prev->next = pst_timer->next;
+        if (pst_timer->next != NULL)
+            pst_timer->next->prev = pst_timer->prev;
+        pst_sub = _etimer_mergePairs(pst_timer->child);
+        gp_etimHeap = _etimer_meld(gp_etimHeap, pst_sub);
+    }
+    pst_timer->next = NULL;
+    pst_timer->child = NULL;
+    pst_timer->prev = NULL;
+    pst_timer->active = TMR_NOT_ACTIVE;
+}
+
+/*============================================================================*/
+/*!
+*   \brief   Add timer to the timer heap
 *
 *    \param        pst_timer        Pointer to a timer to be added
 *    \retval        none
@@ -97,22 +224,20 @@ static     char         gc_init = 0;
 /*============================================================================*/
 static void _etimer_addTimer(struct etimer *pst_timer)
 {
-    list_remove(gp_etimList, pst_timer);
-    list_add(gp_etimList, pst_timer);
+    _etimer_removeTimer(pst_timer);
+    pst_timer->next = NULL;
+    pst_timer->child = NULL;
+    pst_timer->prev = NULL;
+    gp_etimHeap = _etimer_meld(gp_etimHeap, pst_timer);
     pst_timer->active = TMR_ACTIVE;
 }
 
 void etimer_print_list(void)
 {
-    struct etimer * st_temp;
-    uint8_t j=0;
-    LOG_INFO("%s\n\r","timer list");
-    for (st_temp = list_head(gp_etimList); \
-        st_temp != NULL; \
-        st_temp = list_item_next(st_temp), j++) {
-        LOG_RAW("%d | %p : %p : %lu : %lu\n\r",j,st_temp,st_temp->next,st_temp->timer.start,st_temp->timer.interval);
+    LOG_INFO("%s\n\r","timer heap");
+    if (gp_etimHeap != NULL) {
+        LOG_RAW("next %p : %lu : %lu\n\r",gp_etimHeap,gp_etimHeap->timer.start,gp_etimHeap->timer.interval);
     }
-
 }
 /*==============================================================================
                              API FUNCTIONS
@@ -124,7 +249,7 @@ void etimer_init(void)
 {
     if (gc_init)
         return;
-    list_init(gp_etimList);
+    gp_etimHeap = NULL;
     gc_init = 1;
 } /* etimer_init */
 
@@ -133,29 +258,20 @@ void etimer_init(void)
 /*============================================================================*/
 void etimer_request_poll(void)
 {
-    struct    etimer     *    pst_tTim = list_head(gp_etimList);
-    struct    etimer    *    pst_nTim = NULL; ///! Next timer
-    if (pst_tTim == NULL)
-        return;
+    struct    etimer     *    pst_tTim;
     // Importamt to remember that all of the etimer structure are stored in
     // the different modules, that means that etimer library just manages linking
     // between them.
-    // Until we will not point to the NULL keep searching through the list
-    while(pst_tTim != NULL) {
-        pst_nTim = list_item_next(pst_tTim);
-        // We take one by one timer and check if it is expired
-        if(timer_expired(&(pst_tTim->timer))) {
-            LOG_INFO("delete %p from list\n\r",pst_tTim);
-//            etimer_print_list();
-            // Store pointer to a next timer, to check all timers in a list
-            // Generate timer expired event
-            evproc_putEvent(E_EVPROC_TAIL,EVENT_TYPE_TIMER_EXP,pst_tTim);
-            // Remove matched timer from the list
-            list_remove(gp_etimList, pst_tTim);
-            // Change active flag
-            pst_tTim->active = TMR_NOT_ACTIVE;
-        } /* if */
-        pst_tTim = pst_nTim;
+    // Expired timers are always on top of the heap, so stop at the first
+    // one which is still running
+    while(((pst_tTim = gp_etimHeap) != NULL) && \
+          timer_expired(&(pst_tTim->timer))) {
+        LOG_INFO("delete %p from heap\n\r",pst_tTim);
+        // Remove matched timer from the heap and change active flag
+        _etimer_removeTimer(pst_tTim);
+        // Generate timer expired event
+        evproc_putTargetEvent(E_EVPROC_TAIL,EVENT_TYPE_TIMER_EXP,pst_tTim,
+                              pst_tTim->callback);
     } /* while */
 } /* etimer_request_poll() */
 
@@ -165,8 +281,8 @@ void etimer_request_poll(void)
 void etimer_set(struct etimer *pst_et, clock_time_t l_interval, pfn_callback_t pfn_callback)
 {
     timer_set(&pst_et->timer, l_interval);
+    pst_et->callback = pfn_callback;
     _etimer_addTimer(pst_et);
-    evproc_regCallback(EVENT_TYPE_TIMER_EXP, pfn_callback);
     LOG_INFO("add new timer %p\n\r",pst_et);
 //    etimer_print_list();
 }/* etimer_set() */
@@ -197,7 +313,15 @@ etimer_restart(struct etimer *pst_et)
 /*============================================================================*/
 void etimer_adjust(struct etimer *pst_et, int32_t l_timediff)
 {
-    pst_et->timer.start += l_timediff;
+    if (pst_et->active == TMR_ACTIVE) {
+        // Expiration time is the heap key, so the timer has to be re-inserted
+        _etimer_removeTimer(pst_et);
+        pst_et->timer.start += l_timediff;
+        _etimer_addTimer(pst_et);
+    }
+    else {
+        pst_et->timer.start += l_timediff;
+    }
 }/* etimer_adjust() */
 
 /*============================================================================*/
@@ -228,7 +352,7 @@ clock_time_t etimer_start_time(struct etimer *pst_et)
 /*============================================================================*/
 int etimer_pending(void)
 {
-  return gp_etimList != NULL;
+  return gp_etimHeap != NULL;
 }/* etimer_pending() */
 
 /*============================================================================*/
@@ -236,7 +360,7 @@ int etimer_pending(void)
 /*============================================================================*/
 clock_time_t etimer_next_expiration_time(void)
 {
-  return etimer_pending() ? l_nextExp : 0;
+  return etimer_pending() ? etimer_expiration_time(gp_etimHeap) : 0;
 } /* etimer_next_expiration_time() */
 
 /*============================================================================*/
@@ -244,7 +368,7 @@ clock_time_t etimer_next_expiration_time(void)
 /*============================================================================*/
 void etimer_stop(struct etimer *pst_et)
 {
-    list_remove(gp_etimList, pst_et);
+    _etimer_removeTimer(pst_et);
     pst_et->active = TMR_NOT_ACTIVE;
 } /* etimer_stop() */
 
@@ -253,36 +377,9 @@ void etimer_stop(struct etimer *pst_et)
 /*============================================================================*/
 clock_time_t etimer_nextEvent(void)
 {
-  struct    etimer  *   pst_tTim = list_head(gp_etimList);
-  struct    etimer  *   pst_nTim = NULL; ///! Next timer
-  clock_time_t  ct_expTime;
-  clock_time_t  ct_nextExpTime = 0;
-
-  if ( list_length(gp_etimList) == 0 ) /* no items in list */
+  if (gp_etimHeap == NULL) /* no items in heap */
     return TMR_NOT_ACTIVE;
-  else /* search timer with next expiration time */
-  {
-    while(pst_tTim != NULL)
-    {
-      pst_nTim = list_item_next(pst_tTim); /* get next element in list */
-
-      if (pst_tTim->active == TMR_ACTIVE) /* timer enabled? */
-      {
-        ct_expTime = pst_tTim->timer.start + pst_tTim->timer.interval; /* get timer expiration time */
-
-        if ( ct_nextExpTime == 0)
-          ct_nextExpTime = ct_expTime;
-        else
-        {
-          if (ct_expTime < ct_nextExpTime) /* save next expiration time */
-            ct_nextExpTime = ct_expTime;
-        }
-      } /* timer enabled? */
-
-      pst_tTim = pst_nTim;
-    }
-      return (ct_nextExpTime);
-  }
+  return etimer_expiration_time(gp_etimHeap);
 } /* etimer_nextEvent() */
 
 /** @} */
@@ -71,6 +71,11 @@
 //! Enable or disable logging
 #define     LOGGER_ENABLE        LOGGER_EVPROC
 
+//! Size of the duplicates set. Covers normal and low lanes with a load
+//! factor not bigger than one half
+#define     EVPROC_SET_SIZE      (EVPROC_QUEUE_SIZE * 4)
+#define     EVPROC_SET_MASK      (EVPROC_SET_SIZE - 1)
+
 
 /*==============================================================================
                              LOCAL CONSTANTS
@@ -86,7 +91,8 @@
  * \brief Type of a structure to store every callback for particular event.
  * */
 typedef struct {
-    c_event_t        c_event; ///< Event type
+    c_event_t        c_event; ///< Event type, EVENT_TYPE_NONE if slot is unused
+    uint8_t            c_count; ///< Amount of callbacks in pfn_callbList
     pfn_callback_t     pfn_callbList[MAX_CALLBACK_COUNT]; ///< List of a callback functions
 }st_funcReg_t;
 
@@ -97,28 +103,50 @@ typedef struct {
  * */
 typedef struct {
     p_data_t            p_data;  ///< Pointer to a data to be transfered
+    pfn_callback_t        pfn_target; ///< Single receiver or NULL for all subscribers
     c_event_t            c_event; ///< Event type
 }st_eventDisc_t;
 
+/*!
+ * \struct st_evLane_t
+ *
+ * \brief Ring buffer of events of one priority lane
+ * */
+typedef struct {
+    st_eventDisc_t    pst_ev[EVPROC_QUEUE_SIZE]; ///< Events of the lane
+    uint8_t            c_head;  ///< Index of the next event to be taken
+    uint8_t            c_size;  ///< Amount of events in the lane
+}st_evLane_t;
+
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
-/*! Array of functions linked with every defined event */
-static    st_funcReg_t    pst_regList[EVENT_TYPES_COUNT];
+/*! Array of functions linked with every defined event. Indexed directly by
+    an event type */
+static    st_funcReg_t    pst_regList[EVENT_TYPE_MAX + 1];
+
+/*!  Priority lanes of events linked with a data which is associated with
+     this event. Indexed by \ref en_evprocPrio_t */
+static st_evLane_t    pst_evLane[EVPROC_PRIO_COUNT];
 
-/*!  Queue of events linked with a data which is associated with this event */
-static st_eventDisc_t    pst_evList[EVPROC_QUEUE_SIZE];
+/*!  Open addressing set of the events waiting in the normal and low lanes.
+     Used to coalesce duplicates without scanning the lanes */
+static st_eventDisc_t    pst_evSet[EVPROC_SET_SIZE];
+
+/*! Statistics of the event queue */
+static st_evprocStats_t    st_stats;
 
 /*! Flag to detects initialization status of a evproc library */
 static uint8_t c_isInit = 0;
-
-/*!  Queue size. Should be not more than  \ref EVPROC_QUEUE_SIZE */
-static uint8_t    c_queueSize = 0;
 /*==============================================================================
                              LOCAL PROTOTYPES
 ==============================================================================*/
 static    void                 _evproc_init(void);
+static    st_funcReg_t *        _evproc_getReg(c_event_t c_eventType);
 static    en_evprocResCode_t    _evproc_pushEvent(c_event_t c_event_type, p_data_t data);
+static    uint16_t               _evproc_hash(c_event_t c_eventType, p_data_t p_data);
+static    uint8_t                _evproc_lookupEvent(c_event_t c_eventType, p_data_t p_data);
+static    void                 _evproc_removeEvent(c_event_t c_eventType, p_data_t p_data);
 /*==============================================================================
                              LOCAL FUNCTIONS
 ==============================================================================*/
@@ -132,32 +160,44 @@ static    en_evprocResCode_t    _evproc_pushEvent(c_event_t c_event_type, p_data
 /*============================================================================*/
 void _evproc_init(void)
 {
-    uint8_t    i,j;
+    uint8_t    i;
     // Initialize variable by predefined event types macro
     uint8_t pc_eventTypes[EVENT_TYPES_COUNT] = EVENT_TYPES;
 
     // Nullify event queue
-    for (i = 0;i < EVPROC_QUEUE_SIZE; i++) {
-        pst_evList[i].c_event = EVENT_TYPE_NONE;
-        pst_evList[i].p_data = NULL;
-    }
+    memset(pst_evLane, 0, sizeof(pst_evLane));
+    memset(pst_evSet, 0, sizeof(pst_evSet));
+    memset(&st_stats, 0, sizeof(st_stats));
 
     // Assign every callback for every event by NULL pointer
+    memset(pst_regList, 0, sizeof(pst_regList));
     for(i=0; i<EVENT_TYPES_COUNT; i++)
     {
-        // Set "i" event from the list by the one from eventTypes array
-        pst_regList[i].c_event = pc_eventTypes[i];
-        for(j=0;j<MAX_CALLBACK_COUNT;j++)
-        {
-            // Assign "j" callback from the list to NULL pointer
-            pst_regList[i].pfn_callbList[j] = NULL;
-        } /* for */
+        // Mark slot of "i" event from the list as a known one
+        pst_regList[pc_eventTypes[i]].c_event = pc_eventTypes[i];
     } /* for */
 
     // Set init flag to prevent erasing list again
     c_isInit = 1;
 } /* _evl_init() */
 
+/*============================================================================*/
+/*!
+    \brief    Find registration list of an event type
+
+    \param    c_eventType        Type of event
+
+    \return   Pointer to the registration list or NULL if type is unknown
+*/
+/*============================================================================*/
+static st_funcReg_t * _evproc_getReg(c_event_t c_eventType)
+{
+    if ((c_eventType == EVENT_TYPE_NONE) || (c_eventType > EVENT_TYPE_MAX) || \
+        (pst_regList[c_eventType].c_event != c_eventType))
+        return NULL;
+    return &pst_regList[c_eventType];
+}
+
 /*============================================================================*/
 /*!
     \brief    Process input event
@@ -175,47 +215,101 @@ void _evproc_init(void)
 /*============================================================================*/
 en_evprocResCode_t    _evproc_pushEvent(c_event_t c_eventType, p_data_t p_data)
 {
-    uint8_t i,j;
-    // Search for a given event type and try to add given function pointer
-    // to the end of a registration list
-    for(i=0; i<EVENT_TYPES_COUNT; i++)
+    uint8_t j;
+    pfn_callback_t pfn_callback;
+    st_funcReg_t *pst_reg = _evproc_getReg(c_eventType);
+
+    if (pst_reg == NULL) {
+        LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
+        return E_UNKNOWN_TYPE;
+    }
+
+    for (j = 0; j < pst_reg->c_count; j++)
     {
-        // Find given c_eventType in registered list. If no event matches
-        // then generate error code
-        if(pst_regList[i].c_event == c_eventType)
-        {
-            // Event type has been found, now search for registered callbacks
-            for (j = 0; j < MAX_CALLBACK_COUNT; j++)
-            {
-                // If points to a NULL pointer the end of a list has been reached
-                if (pst_regList[i].pfn_callbList[j] == NULL)
-                    return E_SUCCESS;
-                // In every other cases callback should be called
-                else {
-                    pst_regList[i].pfn_callbList[j](c_eventType, p_data);
-                }
-            } /* for */
-            return E_SUCCESS;
-        } /* if */
+        pfn_callback = pst_reg->pfn_callbList[j];
+        pfn_callback(c_eventType, p_data);
+        // Callback could have unregistered itself, then the next one
+        // was moved to the current position
+        if ((j < pst_reg->c_count) && (pst_reg->pfn_callbList[j] != pfn_callback))
+            j--;
     } /* for */
+    return E_SUCCESS;
+}
+
+/*============================================================================*/
+/*!
+    \brief    Calculate home slot of an event in \ref pst_evSet
+*/
+/*============================================================================*/
+static uint16_t _evproc_hash(c_event_t c_eventType, p_data_t p_data)
+{
+    uintptr_t l_key = (uintptr_t)p_data;
 
-    LOG_ERR("unknown type (0x%04X)\n\r", c_eventType);
-    return E_UNKNOWN_TYPE;
+    l_key ^= (l_key >> 8) ^ (l_key >> 4);
+    return (uint16_t)((l_key ^ (c_eventType * 37u)) & EVPROC_SET_MASK);
 }
 
-uint8_t    _evproc_lookupEvent(c_event_t c_eventType,p_data_t     p_data)
+/*============================================================================*/
+/*!
+    \brief    Check whether event with the same data is waiting in the queue
+              and add it to \ref pst_evSet otherwise.
+
+    \retval   1    Event is already in the queue
+    \retval   0    Event was added to the set
+*/
+/*============================================================================*/
+static uint8_t _evproc_lookupEvent(c_event_t c_eventType, p_data_t p_data)
 {
-    uint8_t i;
-    if (c_queueSize != 0) {
-        for (i=0; i<c_queueSize;i++) {
-            if ((pst_evList[i].c_event == c_eventType) && \
-                (pst_evList[i].p_data == p_data))
-                return 1;
-        }
+    uint16_t i = _evproc_hash(c_eventType, p_data);
+
+    // The set is twice as big as the lanes it covers, so a free slot
+    // always terminates the probe sequence
+    while (pst_evSet[i].c_event != EVENT_TYPE_NONE) {
+        if ((pst_evSet[i].c_event == c_eventType) && \
+            (pst_evSet[i].p_data == p_data))
+            return 1;
+        i = (i + 1) & EVPROC_SET_MASK;
     }
+    pst_evSet[i].c_event = c_eventType;
+    pst_evSet[i].p_data = p_data;
     return 0;
 }
 
+/*============================================================================*/
+/*!
+    \brief    Remove event from \ref pst_evSet using backward shift deletion,
+              so no tombstones are left behind.
+*/
+/*============================================================================*/
+static void _evproc_removeEvent(c_event_t c_eventType, p_data_t p_data)
+{
+    uint16_t i = _evproc_hash(c_eventType, p_data);
+    uint16_t j;
+    uint16_t k;
+
+    while ((pst_evSet[i].c_event != c_eventType) || \
+           (pst_evSet[i].p_data != p_data)) {
+        if (pst_evSet[i].c_event == EVENT_TYPE_NONE)
+            return;
+        i = (i + 1) & EVPROC_SET_MASK;
+    }
+
+    for (j = (i + 1) & EVPROC_SET_MASK;
+         pst_evSet[j].c_event != EVENT_TYPE_NONE;
+         j = (j + 1) & EVPROC_SET_MASK) {
+        k = _evproc_hash(pst_evSet[j].c_event, pst_evSet[j].p_data);
+        // Move entry j into the hole unless its home slot lies cyclically
+        // in (i, j]
+        if (((j > i) && ((k <= i) || (k > j))) ||
+            ((j < i) && ((k <= i) && (k > j)))) {
+            pst_evSet[i] = pst_evSet[j];
+            i = j;
+        }
+    }
+    pst_evSet[i].c_event = EVENT_TYPE_NONE;
+    pst_evSet[i].p_data = NULL;
+}
+
 
 /*==============================================================================
                              API FUNCTIONS
@@ -226,7 +320,8 @@ uint8_t    _evproc_lookupEvent(c_event_t c_eventType,p_data_t     p_data)
 /*============================================================================*/
 en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_callback)
 {
-    uint8_t i,j;
+    uint8_t j;
+    st_funcReg_t *pst_reg;
 
     // If event process wasn't initialized before do it now.
     if (!c_isInit)
@@ -238,46 +333,32 @@ en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_
         return E_INVALID_PARAM;
     } /* if */
 
-    // Search for a given event type and try to add given function pointer
-    // to the end of a registration list
-    for(i=0; i<EVENT_TYPES_COUNT; i++)
+    pst_reg = _evproc_getReg(c_eventType);
+    if (pst_reg == NULL) {
+        LOG_ERR("unknown event type (0x%02X)\n\r", c_eventType);
+        return E_UNKNOWN_TYPE;
+    }
+
+    for(j=0; j<pst_reg->c_count; j++)
     {
-        // Find given c_eventType in registered list. If no event matches
-        // then generate error code
-        if(pst_regList[i].c_event == c_eventType)
-        {
-            // Event type has been found, now search for registered callbacks
-            for(j=0; j<MAX_CALLBACK_COUNT; j++)
-            {
-                // If "j" callback from registration list points to NULL
-                // it means that end of a list has been reached.
-                if(pst_regList[i].pfn_callbList[j] == NULL) {
-                    // Given function pointer for a given event type has been added
-                    LOG_INFO("new callback for (%d) event with callback %p\n\r", c_eventType, pfn_callback);
-                    pst_regList[i].pfn_callbList[j] = pfn_callback;
-                    return E_SUCCESS;
-                } /* if */
-
-                // If "j" callback is equal to a given function pointer
-                // it means that this function for a given event has been
-                // registered yet.
-                if(pst_regList[i].pfn_callbList[j] == pfn_callback) {
-                    LOG_ERR(" (%d) already registered\n\r",c_eventType);
-                    return E_FUNC_IN_LIST;
-                } /* if */
-
-            } /* for */
-
-            // If end of the registration list has been reached and
-            // c_callbI index are equal to a maximum allowed callbacks
-            // generate an error.
-            LOG_ERR("limit is reached (%d)\n\r", MAX_CALLBACK_COUNT);
-            return E_END_OF_LIST;
+        // If "j" callback is equal to a given function pointer
+        // it means that this function for a given event has been
+        // registered yet.
+        if(pst_reg->pfn_callbList[j] == pfn_callback) {
+            LOG_ERR(" (%d) already registered\n\r",c_eventType);
+            return E_FUNC_IN_LIST;
         } /* if */
     } /* for */
 
-    LOG_ERR("unknown event type (0x%02X)\n\r", c_eventType);
-    return E_UNKNOWN_TYPE;
+    if (pst_reg->c_count == MAX_CALLBACK_COUNT) {
+        LOG_ERR("limit is reached (%d)\n\r", MAX_CALLBACK_COUNT);
+        return E_END_OF_LIST;
+    }
+
+    // Given function pointer for a given event type has been added
+    LOG_INFO("new callback for (%d) event with callback %p\n\r", c_eventType, pfn_callback);
+    pst_reg->pfn_callbList[pst_reg->c_count++] = pfn_callback;
+    return E_SUCCESS;
 }
 
 /*============================================================================*/
@@ -285,35 +366,31 @@ en_evprocResCode_t evproc_regCallback(c_event_t c_eventType, pfn_callback_t pfn_
 /*============================================================================*/
 en_evprocResCode_t evproc_unregCallback(c_event_t c_eventType, pfn_callback_t pfn_callback)
 {
-    uint8_t i,j;
+    uint8_t j;
+    st_funcReg_t *pst_reg = _evproc_getReg(c_eventType);
 
-    // Search for a given event type and try to add given function pointer
-    // to the end of a registration list
-    for(i=0; i<EVENT_TYPES_COUNT; i++)
+    if (pst_reg == NULL) {
+        LOG_ERR(" unknown event type (0x%04X)\n\r", c_eventType);
+        return E_UNKNOWN_TYPE;
+    }
+
+    for(j=0; j<pst_reg->c_count; j++)
     {
-        // Find given c_eventType in registered list. If no event matches
-        // then generate error code
-        if(pst_regList[i].c_event == c_eventType)
-        {
-            // Event type has been found, now search for registered callbacks
-            for(j=0; j<MAX_CALLBACK_COUNT; j++)
-            {
-                // If "j" callback is equal to a given function pointer
-                // it means that this function for a given event has been
-                // found.
-                if(pst_regList[i].pfn_callbList[j] == pfn_callback) {
-                    pst_regList[i].pfn_callbList[j] = NULL;
-                    return E_SUCCESS;
-                } /* if */
-            } /* for */
-
-            LOG_ERR("%s\n\r","function wasn't registered");
-            return E_NO_SUCH_FUNC;
+        // If "j" callback is equal to a given function pointer
+        // it means that this function for a given event has been
+        // found.
+        if(pst_reg->pfn_callbList[j] == pfn_callback) {
+            pst_reg->c_count--;
+            // Close the gap to keep list dense
+            for (; j < pst_reg->c_count; j++)
+                pst_reg->pfn_callbList[j] = pst_reg->pfn_callbList[j + 1];
+            pst_reg->pfn_callbList[j] = NULL;
+            return E_SUCCESS;
         } /* if */
     } /* for */
 
-    LOG_ERR(" unknown event type (0x%04X)\n\r", c_eventType);
-    return E_UNKNOWN_TYPE;
+    LOG_ERR("%s\n\r","function wasn't registered");
+    return E_NO_SUCH_FUNC;
 }
 
 /*============================================================================*/
@@ -323,64 +400,82 @@ en_evprocResCode_t evproc_putEvent(        en_evprocAction_t     e_actType, \
                                         c_event_t             c_eventType, \
                                         p_data_t             p_data)
 {
-    int8_t i;
-    bsp_enterCritical();
+    return evproc_putTargetEvent(e_actType, c_eventType, p_data, NULL);
+} /* evproc_putEvent() */
+
+/*============================================================================*/
+/*  evproc_putTargetEvent()                                                   */
+/*============================================================================*/
+en_evprocResCode_t evproc_putTargetEvent(en_evprocAction_t     e_actType, \
+                                        c_event_t             c_eventType, \
+                                        p_data_t             p_data, \
+                                        pfn_callback_t       pfn_target)
+{
+    en_evprocPrio_t e_prio;
+    st_evLane_t *pst_lane;
+    st_eventDisc_t *pst_ev;
+
+    if (!c_isInit)
+        _evproc_init();
+
     switch (e_actType)
     {
         case  E_EVPROC_HEAD:
-            if (c_queueSize == EVPROC_QUEUE_SIZE) {
-            //    printf("Not enogh space in a queue\n\r");
-                bsp_exitCritical();
-                return E_END_OF_LIST;
-            }
-            if ((c_eventType < OBLIG_EVENT_PRIOR) && (_evproc_lookupEvent(c_eventType,p_data))) {
-                // Event has low priority and already in a queue
-            }
-            else {
-                LOG_INFO("head %d : %p\n\r",c_eventType,p_data);
-                pst_evList[c_queueSize].c_event = c_eventType;
-                pst_evList[c_queueSize].p_data = p_data;
-                c_queueSize++;
-            }
-            bsp_exitCritical();
+            e_prio = E_EVPROC_PRIO_NORMAL;
             break;
         case  E_EVPROC_TAIL:
-            if (c_queueSize == EVPROC_QUEUE_SIZE) {
-            //    printf("Not enough space in a queue\n\r");
-                bsp_exitCritical();
-                return E_END_OF_LIST;
-            }
-            if ((c_eventType < OBLIG_EVENT_PRIOR) && (_evproc_lookupEvent(c_eventType,p_data))) {
-                // Event has low priority and already in a queue
-            }
-            else {
-
-                for (i=c_queueSize; i > 0; i--) {
-                    pst_evList[i].c_event = pst_evList[i - 1].c_event;
-                    pst_evList[i].p_data = pst_evList[i - 1].p_data;
-                    //memcpy((&pst_evList + i),(&pst_evList + (i-1)),sizeof(st_eventDisc_t));
-                }
-                LOG_INFO("tail %d : %p\n\r",c_eventType,p_data);
-                pst_evList[0].c_event = c_eventType;
-                pst_evList[0].p_data = p_data;
-                c_queueSize++;
-            }
-            bsp_exitCritical();
+            e_prio = E_EVPROC_PRIO_LOW;
             break;
         case  E_EVPROC_EXEC:
             LOG_INFO("Execute event %d\n\r",c_eventType);
-            bsp_exitCritical();
-            if (!_evproc_pushEvent(c_eventType,p_data)) {
+            if (pfn_target != NULL) {
+                pfn_target(c_eventType,p_data);
+            }
+            else if (!_evproc_pushEvent(c_eventType,p_data)) {
                 return E_UNKNOWN_TYPE;
             }
-            break;
+            return E_SUCCESS;
         default:
             LOG_INFO("%s","Not known\n\r");
-            bsp_exitCritical();
             return E_UNKNOWN_TYPE;
     }
+
+    // Packets from the radio must be never merged or delayed by other events
+    if (c_eventType == EVENT_TYPE_PCK_LL)
+        e_prio = E_EVPROC_PRIO_HIGH;
+
+    pst_lane = &pst_evLane[e_prio];
+
+    bsp_enterCritical();
+    if ((e_prio != E_EVPROC_PRIO_HIGH) && \
+        (_evproc_lookupEvent(c_eventType,p_data))) {
+        // Event has low priority and already in a queue
+        st_stats.l_coalesced++;
+    }
+    else if (pst_lane->c_size == EVPROC_QUEUE_SIZE) {
+        if (e_prio != E_EVPROC_PRIO_HIGH)
+            _evproc_removeEvent(c_eventType,p_data);
+        st_stats.l_dropped[e_prio]++;
+        bsp_exitCritical();
+        LOG_ERR("lane %d is full, event %d dropped\n\r", e_prio, c_eventType);
+        return E_END_OF_LIST;
+    }
+    else {
+        LOG_INFO("lane %d : %d : %p\n\r",e_prio,c_eventType,p_data);
+        pst_ev = &pst_lane->pst_ev[(pst_lane->c_head + pst_lane->c_size) & \
+                                   (EVPROC_QUEUE_SIZE - 1)];
+        pst_ev->c_event = c_eventType;
+        pst_ev->p_data = p_data;
+        pst_ev->pfn_target = pfn_target;
+        pst_lane->c_size++;
+        st_stats.l_put[e_prio]++;
+        if (pst_lane->c_size > st_stats.c_maxDepth[e_prio])
+            st_stats.c_maxDepth[e_prio] = pst_lane->c_size;
+    }
+    bsp_exitCritical();
+
     return E_SUCCESS;
-} /* evproc_putEvent() */
+} /* evproc_putTargetEvent() */
 
 
 /*============================================================================*/
@@ -388,25 +483,48 @@ en_evprocResCode_t evproc_putEvent(        en_evprocAction_t     e_actType, \
 /*============================================================================*/
 en_evprocResCode_t evproc_nextEvent(void)
 {
-    st_eventDisc_t nextEvent = {NULL,0};
+    st_eventDisc_t nextEvent = {NULL,NULL,0};
+    st_evLane_t *pst_lane;
     uint8_t i;
-    if (c_queueSize > 0) {
-        bsp_enterCritical();
-        LOG_INFO("%s\n\r","Event queue");
-        for (i=0; i<c_queueSize;i++)
-            LOG_RAW("%d | ev = %d : %p\n\r",i,pst_evList[i].c_event,pst_evList[i].p_data);
-        nextEvent.c_event = pst_evList[c_queueSize-1].c_event;
-        nextEvent.p_data = pst_evList[c_queueSize-1].p_data;
-        pst_evList[c_queueSize-1].c_event = 0;
-        pst_evList[c_queueSize-1].p_data = NULL;
-        c_queueSize--;
-        bsp_exitCritical();
-        if (!_evproc_pushEvent(nextEvent.c_event,nextEvent.p_data)) {
-            return E_UNKNOWN_TYPE;
+
+    for (i = 0; i < EVPROC_PRIO_COUNT; i++) {
+        pst_lane = &pst_evLane[i];
+        if (pst_lane->c_size > 0) {
+            bsp_enterCritical();
+            LOG_INFO("lane %d : %d events\n\r", i, pst_lane->c_size);
+            nextEvent = pst_lane->pst_ev[pst_lane->c_head];
+            pst_lane->pst_ev[pst_lane->c_head].c_event = EVENT_TYPE_NONE;
+            pst_lane->pst_ev[pst_lane->c_head].p_data = NULL;
+            pst_lane->pst_ev[pst_lane->c_head].pfn_target = NULL;
+            pst_lane->c_head = (pst_lane->c_head + 1) & (EVPROC_QUEUE_SIZE - 1);
+            pst_lane->c_size--;
+            if (i != E_EVPROC_PRIO_HIGH)
+                _evproc_removeEvent(nextEvent.c_event, nextEvent.p_data);
+            bsp_exitCritical();
+            if (nextEvent.pfn_target != NULL) {
+                nextEvent.pfn_target(nextEvent.c_event,nextEvent.p_data);
+            }
+            else if (!_evproc_pushEvent(nextEvent.c_event,nextEvent.p_data)) {
+                return E_UNKNOWN_TYPE;
+            }
+            return E_SUCCESS;
         }
-        return E_SUCCESS;
     }
     return E_QUEUE_EMPTY;
 } /* evproc_nextEvent() */
 
+/*============================================================================*/
+/*  evproc_getStats()                                                         */
+/*============================================================================*/
+en_evprocResCode_t evproc_getStats(st_evprocStats_t *pst_stats)
+{
+    if (pst_stats == NULL)
+        return E_INVALID_PARAM;
+
+    bsp_enterCritical();
+    memcpy(pst_stats, &st_stats, sizeof(st_stats));
+    bsp_exitCritical();
+    return E_SUCCESS;
+} /* evproc_getStats() */
+
 /** @} */
@@ -46,57 +46,81 @@
 
 #include "memb.h"
 
+/*---------------------------------------------------------------------------*/
+/* Index of the lowest bit set in a non-zero word */
+#if defined(__GNUC__)
+#define LOWEST_BIT(w) __builtin_ctzl((unsigned long)(w))
+#else
+static const uint8_t debruijn_bit[32] = {
+  0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+  31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+#define LOWEST_BIT(w) \
+  debruijn_bit[(uint32_t)(((w) & -(w)) * 0x077CB531UL) >> 27]
+#endif
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
-  memset(m->count, 0, m->num);
+  memset(m->used, 0, ((m->num + 31) / 32) * sizeof(uint32_t));
   memset(m->mem, 0, m->size * m->num);
+  m->nused = 0;
+  m->hiwater = 0;
 }
 /*---------------------------------------------------------------------------*/
 void *
 memb_alloc(struct memb *m)
 {
-  int i;
+  int w, i;
+  uint32_t free_bits;
+
+  if(m->nused == m->num) {
+    /* No free block, so we return NULL to indicate failure to
+       allocate block. */
+    return NULL;
+  }
 
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      /* If this block was unused, we increase the reference count to
-     indicate that it now is used and return a pointer to the
-     memory block. */
-      ++(m->count[i]);
-      return (void *)((char *)m->mem + (i * m->size));
+  /* Every word but the last one covers 32 blocks, so a free block is
+     found in the first word having a clear bit. */
+  for(w = 0; ; ++w) {
+    free_bits = ~m->used[w];
+    if(free_bits != 0) {
+      break;
     }
   }
+  i = w * 32 + LOWEST_BIT(free_bits);
 
-  /* No free block was found, so we return NULL to indicate failure to
-     allocate block. */
-  return NULL;
+  m->used[w] |= (uint32_t)1 << (i & 31);
+  if(++m->nused > m->hiwater) {
+    m->hiwater = m->nused;
+  }
+  return (void *)((char *)m->mem + (i * m->size));
 }
 /*---------------------------------------------------------------------------*/
 char
 memb_free(struct memb *m, void *ptr)
 {
-  int i;
-  char *ptr2;
+  unsigned int offset;
+  unsigned int i;
+  uint32_t bit;
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    
-    if(ptr2 == (char *)ptr) {
-      /* We've found to block to which "ptr" points so we decrease the
-     reference count and return the new value of it. */
-      if(m->count[i] > 0) {
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  i = offset / m->size;
+  if(i * m->size != offset) {
+    /* Not the start of a block */
+    return -1;
+  }
+
+  bit = (uint32_t)1 << (i & 31);
+  if(m->used[i / 32] & bit) {
     /* Make sure that we don't deallocate free memory. */
-    --(m->count[i]);
-      }
-      return m->count[i];
-    }
-    ptr2 += m->size;
+    m->used[i / 32] &= ~bit;
+    --m->nused;
   }
-  return -1;
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -109,16 +133,13 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
-  int i;
-  int num_free = 0;
-
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      ++num_free;
-    }
-  }
-
-  return num_free;
+  return m->num - m->nused;
+}
+/*---------------------------------------------------------------------------*/
+int
+memb_hiwater(struct memb *m)
+{
+  return m->hiwater;
 }
 
 /** @} */
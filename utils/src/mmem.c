@@ -44,6 +44,7 @@
  */
 
 
+#include "emb6_conf.h"
 #include "mmem.h"
 #include "clist.h"
 //#include "lib_conf.h"
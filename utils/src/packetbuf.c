@@ -45,6 +45,7 @@
 
 #include "emb6.h"
 #include "packetbuf.h"
+#include "queuebuf.h"
 
 //#include <stdint.h>
 //#include <string.h>
@@ -58,14 +59,30 @@ struct packetbuf_addr packetbuf_addrs[PACKETBUF_NUM_ADDRS];
 static uint16_t buflen, bufptr;
 static uint8_t hdrptr;
 
+/* Frames are shared between the packetbuf and the queuebufs holding
+   them. One is always used by the packetbuf, every other one may be
+   held by at most one queuebuf. */
+#define PACKETBUF_FRAMES (QUEUEBUF_NUM + 1)
+
 /* The declarations below ensure that the packet buffer is aligned on
    an even 32-bit boundary. On some platforms (most notably the
    msp430 or OpenRISC), having a potentially misaligned packet buffer may lead to
    problems when accessing words. */
-static uint32_t packetbuf_aligned[(PACKETBUF_SIZE + PACKETBUF_HDR_SIZE + 3) / 4];
-static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
+struct packetbuf_frame {
+  uint32_t aligned[(PACKETBUF_SIZE + PACKETBUF_HDR_SIZE + 3) / 4];
+  /* Number of holders, the packetbuf included */
+  uint8_t refcnt;
+  /* Lowest header offset used by a queuebuf holding the frame */
+  uint8_t hdrlow;
+};
+
+static struct packetbuf_frame frames[PACKETBUF_FRAMES] = {
+  { .refcnt = 1, .hdrlow = PACKETBUF_HDR_SIZE }
+};
+static struct packetbuf_frame *frame = &frames[0];
+#define packetbuf ((uint8_t *)frame->aligned)
 
-static uint8_t *packetbufptr;
+static uint8_t *packetbufptr = (uint8_t *)frames[0].aligned + PACKETBUF_HDR_SIZE;
 
 #define DEBUG DEBUG_NONE
 #if DEBUG
@@ -75,10 +92,55 @@ static uint8_t *packetbufptr;
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+static struct packetbuf_frame *
+frame_alloc(void)
+{
+  int i;
+
+  for(i = 0; i < PACKETBUF_FRAMES; i++) {
+    if(frames[i].refcnt == 0) {
+      frames[i].refcnt = 1;
+      frames[i].hdrlow = PACKETBUF_HDR_SIZE;
+      return &frames[i];
+    }
+  }
+  /* Cannot happen, there is one frame per queuebuf */
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+frame_release(struct packetbuf_frame *f)
+{
+  if(--f->refcnt == 1) {
+    f->hdrlow = PACKETBUF_HDR_SIZE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Switch to a frame of our own if a queuebuf still holds the current
+   one. The content is copied along if keep is set. */
+static void
+frame_detach(int keep)
+{
+  struct packetbuf_frame *f;
+
+  if(frame->refcnt > 1) {
+    f = frame_alloc();
+    if(keep) {
+      memcpy(f->aligned, frame->aligned, sizeof(f->aligned));
+    }
+    if(packetbufptr == &packetbuf[PACKETBUF_HDR_SIZE]) {
+      packetbufptr = (uint8_t *)f->aligned + PACKETBUF_HDR_SIZE;
+    }
+    frame_release(frame);
+    frame = f;
+  }
+}
 /*---------------------------------------------------------------------------*/
 void
 packetbuf_clear(void)
 {
+  frame_detach(0);
   buflen = bufptr = 0;
   hdrptr = PACKETBUF_HDR_SIZE;
 
@@ -110,9 +172,11 @@ packetbuf_compact(void)
   int i, len;
 
   if(packetbuf_is_reference()) {
+    frame_detach(1);
     memcpy(&packetbuf[PACKETBUF_HDR_SIZE], packetbuf_reference_ptr(),
        packetbuf_datalen());
   } else if (bufptr > 0) {
+    frame_detach(1);
     len = packetbuf_datalen() + PACKETBUF_HDR_SIZE;
     for(i = PACKETBUF_HDR_SIZE; i < len; i++) {
       packetbuf[i] = packetbuf[bufptr + i];
@@ -175,6 +239,10 @@ int
 packetbuf_hdralloc(int size)
 {
   if(hdrptr >= size && packetbuf_totlen() + size <= PACKETBUF_SIZE) {
+    if(hdrptr > frame->hdrlow) {
+      /* The new header would overwrite the one of a queuebuf */
+      frame_detach(1);
+    }
     hdrptr -= size;
     return 1;
   }
@@ -200,6 +268,60 @@ packetbuf_hdrreduce(int size)
 }
 /*---------------------------------------------------------------------------*/
 void
+packetbuf_desc_hold(struct packetbuf_desc *d)
+{
+  if(hdrptr < PACKETBUF_HDR_SIZE && bufptr > 0) {
+    /* Make header and data consecutive */
+    packetbuf_compact();
+  }
+  frame->refcnt++;
+  if(hdrptr < frame->hdrlow) {
+    frame->hdrlow = hdrptr;
+  }
+  d->frame = frame;
+  d->hdrptr = hdrptr;
+  d->bufptr = bufptr;
+  d->buflen = buflen;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_desc_load(const struct packetbuf_desc *d)
+{
+  d->frame->refcnt++;
+  frame_release(frame);
+  frame = d->frame;
+  if(d->hdrptr < frame->hdrlow) {
+    frame->hdrlow = d->hdrptr;
+  }
+  packetbufptr = &packetbuf[PACKETBUF_HDR_SIZE];
+  hdrptr = d->hdrptr;
+  bufptr = d->bufptr;
+  buflen = d->buflen;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_desc_release(struct packetbuf_desc *d)
+{
+  frame_release(d->frame);
+  d->frame = NULL;
+}
+/*---------------------------------------------------------------------------*/
+void *
+packetbuf_desc_ptr(const struct packetbuf_desc *d)
+{
+  if(d->hdrptr < PACKETBUF_HDR_SIZE) {
+    return (uint8_t *)d->frame->aligned + d->hdrptr;
+  }
+  return (uint8_t *)d->frame->aligned + PACKETBUF_HDR_SIZE + d->bufptr;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+packetbuf_desc_len(const struct packetbuf_desc *d)
+{
+  return PACKETBUF_HDR_SIZE - d->hdrptr + d->buflen;
+}
+/*---------------------------------------------------------------------------*/
+void
 packetbuf_set_datalen(uint16_t len)
 {
   PRINTF("packetbuf_set_len: len %d\n", len);